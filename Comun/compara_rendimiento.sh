@@ -0,0 +1,119 @@
+#!/bin/bash
+# =============================================================
+# compara_rendimiento.sh - Eventos/s y costo por paso entre dos commits
+# =============================================================
+# Uso: Comun/compara_rendimiento.sh <app> <commit_antes> <commit_despues> <macro> [eventos] [hilos] [repeticiones]
+#   app:   Simulacion_Europio, Simulacion_Barrido o Simulacion_TierrasRaras
+#   macro: inicialización y fuente, SIN /run/beamOn, con comandos que
+#          existan en los dos commits (ej. Simulacion_Europio/rendimiento_Eu152.mac)
+#   Ej.:   Comun/compara_rendimiento.sh Simulacion_Europio 97f0262^ fc28d73 \
+#              Simulacion_Europio/rendimiento_Eu152.mac 200000 8 5
+#
+# Compila la app en cada commit (git worktree temporal) y corre la macro
+# con /run/beamOn 0 y con /run/beamOn <eventos>: la diferencia de tiempo
+# real es el bucle de eventos, sin la inicialización. Así sirve también
+# para commits anteriores a la línea de eventos/s de RunTimer. Se toma la
+# mediana de las repeticiones; los hilos se fijan con G4FORCENUMBEROFTHREADS
+# (los main.cc viejos no tienen --threads).
+#
+# Si el commit posterior tiene el perfil (/MedidorTR/profile/), se cuentan
+# además los pasos por evento y se da el costo por paso:
+#   (1/R_antes - 1/R_despues) * hilos / pasos_por_evento
+# Resultado en rendimiento_<antes>_<despues>.csv (una fila por commit).
+
+if [ $# -lt 4 ]; then
+    sed -n '5,9p' "$0"
+    exit 1
+fi
+
+APP=$1
+ANTES=$2
+DESPUES=$3
+MACRO=$(readlink -f "$4")
+EVENTOS=${5:-200000}
+HILOS=${6:-$(nproc)}
+REPETICIONES=${7:-5}
+
+RAIZ=$(git rev-parse --show-toplevel) || exit 1
+TMP=$(mktemp -d /tmp/rendimiento_XXXXXX)
+trap 'git -C "$RAIZ" worktree remove --force "$TMP/antes" 2>/dev/null;
+      git -C "$RAIZ" worktree remove --force "$TMP/despues" 2>/dev/null;
+      rm -rf "$TMP"' EXIT
+
+if [ ! -f "$MACRO" ]; then
+    echo "ERROR: No se encuentra la macro $4"
+    exit 1
+fi
+
+# --- 1. COMPILACIÓN DE LOS DOS COMMITS ---
+compilar() {
+    local nombre=$1 commit=$2
+    git -C "$RAIZ" worktree add --detach "$TMP/$nombre" "$commit" > /dev/null || return 1
+    cmake -S "$TMP/$nombre/$APP" -B "$TMP/$nombre/build" -DCMAKE_BUILD_TYPE=Release > /dev/null \
+        && cmake --build "$TMP/$nombre/build" -j"$(nproc)" > /dev/null
+}
+
+# --- 2. TIEMPO REAL DE UNA CORRIDA ---
+# Se corre en un directorio propio: los archivos de salida no se mezclan
+correr() {
+    local nombre=$1 n=$2
+    local dir="$TMP/$nombre/corrida"
+    mkdir -p "$dir"
+    printf '/control/execute %s\n/run/beamOn %s\n' "$MACRO" "$n" > "$dir/medida.mac"
+    local t0 t1
+    t0=$(date +%s.%N)
+    (cd "$dir" && G4FORCENUMBEROFTHREADS=$HILOS "$TMP/$nombre/build/$APP" medida.mac > salida.log 2>&1) || return 1
+    t1=$(date +%s.%N)
+    awk -v a=$t0 -v b=$t1 'BEGIN { printf "%.3f", b - a }'
+}
+
+mediana() {
+    tr ' ' '\n' | sort -g | awk '{ v[NR] = $1 } END { print (NR % 2) ? v[(NR + 1) / 2] : (v[NR / 2] + v[NR / 2 + 1]) / 2 }'
+}
+
+# Eventos/s del bucle de eventos (mediana de las repeticiones)
+medir() {
+    local nombre=$1 tasas="" t0 t1
+    for ((r = 0; r < REPETICIONES; r++)); do
+        t0=$(correr $nombre 0) || return 1
+        t1=$(correr $nombre $EVENTOS) || return 1
+        tasas+="$(awk -v n=$EVENTOS -v a=$t0 -v b=$t1 'BEGIN { print (b > a) ? n / (b - a) : 0 }') "
+    done
+    echo $tasas | mediana
+}
+
+echo "=== $APP: $ANTES -> $DESPUES ($EVENTOS eventos, $HILOS hilos, $REPETICIONES repeticiones) ==="
+for nombre in antes despues; do
+    commit=$ANTES; [ $nombre = despues ] && commit=$DESPUES
+    echo "Compilando $nombre ($commit)..."
+    if ! compilar $nombre $commit; then
+        echo "ERROR: no se pudo compilar $APP en $commit"
+        exit 1
+    fi
+done
+
+TASA_ANTES=$(medir antes)       || { echo "ERROR: falló la corrida en $ANTES";   exit 1; }
+TASA_DESPUES=$(medir despues)   || { echo "ERROR: falló la corrida en $DESPUES"; exit 1; }
+
+# --- 3. PASOS POR EVENTO (perfil del commit posterior) ---
+PASOS=""
+DIR="$TMP/despues/corrida"
+printf '/MedidorTR/profile/enable true\n/control/execute %s\n/run/beamOn %s\n' "$MACRO" "$EVENTOS" > "$DIR/perfil.mac"
+if (cd "$DIR" && G4FORCENUMBEROFTHREADS=$HILOS "$TMP/despues/build/$APP" perfil.mac > perfil.log 2>&1); then
+    PASOS=$(grep ">>> \[Master\] Perfil:" "$DIR/perfil.log" | tail -1 | sed -E 's/.*Perfil: ([0-9]+) pasos.*/\1/')
+fi
+
+# --- 4. RESULTADO ---
+SALIDA="rendimiento_$(git -C "$RAIZ" rev-parse --short "$ANTES")_$(git -C "$RAIZ" rev-parse --short "$DESPUES").csv"
+echo "commit,eventos,hilos,eventos_s,pasos_evento,ns_paso_ahorrados" > "$SALIDA"
+awk -v a=$TASA_ANTES -v d=$TASA_DESPUES -v p="$PASOS" -v n=$EVENTOS -v h=$HILOS \
+    -v ca="$ANTES" -v cd="$DESPUES" 'BEGIN {
+        pe = (p != "") ? p / n : 0
+        ns = (pe > 0 && a > 0 && d > 0) ? 1e9 * (1 / a - 1 / d) * h / pe : 0
+        printf "%s,%d,%d,%.1f,,\n", ca, n, h, a
+        printf "%s,%d,%d,%.1f,%s,%s\n", cd, n, h, d, (pe > 0) ? sprintf("%.1f", pe) : "", (pe > 0) ? sprintf("%.1f", ns) : ""
+        printf "    antes:   %12.1f eventos/s\n", a > "/dev/stderr"
+        printf "    despues: %12.1f eventos/s (x%.3f)\n", d, (a > 0) ? d / a : 0 > "/dev/stderr"
+        if (pe > 0) printf "    %.1f pasos/evento -> %.1f ns ahorrados por paso (tiempo de hilo)\n", pe, ns > "/dev/stderr"
+    }' >> "$SALIDA"
+echo "=== Resultado en $SALIDA ==="
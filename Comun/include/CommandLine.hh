@@ -0,0 +1,55 @@
+#ifndef CommandLine_h
+#define CommandLine_h 1
+
+#include "globals.hh"
+#include "G4RunManagerFactory.hh"
+#include <vector>
+
+class G4RunManager;
+
+// Opciones de la línea de comandos, las mismas en las tres aplicaciones:
+//   <programa> [opciones] [macro1.mac macro2.mac ...]
+//   -t, --threads N|auto              hilos (auto = núcleos de la máquina)
+//   -s, --seed N                      semilla del motor aleatorio del Master
+//   -o, --output-dir DIR              directorio de trabajo para las salidas
+//   -r, --run-manager TIPO            default | serial | mt | tasking
+//   -e, --events-per-thread-batch N   eventos por lote de cada hilo (eventModulo)
+//       --seed-once-per-batch         una semilla por lote y no por evento
+//   -g, --grain-size N                bloques en que se reparte el run (tasking)
+//   -i, --interactive                 abrir la sesión interactiva después de las macros
+//   -h, --help
+// Sin macros se abre la sesión interactiva con init_vis.mac, como antes.
+// Si G4FORCENUMBEROFTHREADS está definida, Geant4 la usa y --threads se ignora.
+class CommandLine
+{
+  public:
+    CommandLine(G4int defaultThreads);
+
+    // false si hay un error o se pidió --help (ver IsHelp)
+    G4bool Parse(int argc, char** argv);
+    void   PrintUsage(const char* program) const;
+
+    // Hilos, semilla, lotes y directorio de salida. Va después de crear el
+    // RunManager y antes de ejecutar las macros. false si el directorio de
+    // salida no se puede usar.
+    G4bool Apply(G4RunManager* runManager);
+
+    G4RunManagerType GetRunManagerType() const { return fRunManagerType; }
+    G4bool IsHelp() const        { return fHelp; }
+    G4bool IsInteractive() const { return fInteractive || fMacros.empty(); }
+    const std::vector<G4String>& GetMacros() const { return fMacros; }
+
+  private:
+    G4int    fThreads;    // -1 = auto, 0 = valor por defecto de Geant4
+    G4long   fSeed;       // 0 = no cambiar la semilla
+    G4String fOutputDir;
+    G4int    fEventModulo; // 0 = valor por defecto de Geant4
+    G4bool   fSeedOncePerBatch;
+    G4int    fGrainSize;   // 0 = valor por defecto de Geant4
+    G4RunManagerType fRunManagerType;
+    G4bool   fInteractive;
+    G4bool   fHelp;
+    std::vector<G4String> fMacros;
+};
+
+#endif
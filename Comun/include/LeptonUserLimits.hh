@@ -0,0 +1,22 @@
+#ifndef LeptonUserLimits_h
+#define LeptonUserLimits_h 1
+
+#include "G4UserLimits.hh"
+#include "globals.hh"
+
+class G4Track;
+
+// Energía mínima de una región (/MedidorTR/regions/emin...) solo para
+// e-/e+. G4UserSpecialCuts la aplica a todas las partículas cargadas:
+// los iones de retroceso excitados nacen con Ekin << 10 keV y deben
+// decaer (sus gammas son la fuente), así que para ellos y para cualquier
+// otra partícula el mínimo es 0. Los gammas no se cortan nunca.
+class LeptonUserLimits : public G4UserLimits
+{
+  public:
+    explicit LeptonUserLimits(G4double minEkine);
+
+    G4double GetUserMinEkine(const G4Track& track) override;
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef RunTimer_h
+#define RunTimer_h 1
+
+#include "G4Timer.hh"
+#include "globals.hh"
+
+class G4Run;
+
+// Rendimiento de un run, compartido por las tres aplicaciones (solo el
+// Master lo usa): tiempo real de todo el run, todos los hilos. Al final
+// imprime
+//   >>> [Master] Run <id>: <N> eventos en <T> s (<R> eventos/s)
+// la línea que leen escalado_hilos.sh y Comun/compara_rendimiento.sh.
+class RunTimer
+{
+  public:
+    void Start();
+    void Stop(const G4Run* run);
+
+  private:
+    G4Timer fTimer;
+};
+
+#endif
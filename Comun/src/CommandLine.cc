@@ -0,0 +1,213 @@
+#include "CommandLine.hh"
+
+#include "G4RunManager.hh"
+#include "G4MTRunManager.hh"
+#include "G4TaskRunManager.hh"
+#include "G4UImanager.hh"
+#include "G4Threading.hh"
+#include "Randomize.hh"
+
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+namespace
+{
+    // Entero positivo completo ("12abc" no vale)
+    G4bool ParsePositive(const std::string& text, G4long& value)
+    {
+        try {
+            std::size_t used = 0;
+            value = std::stol(text, &used);
+            return used == text.size() && value > 0;
+        } catch (...) {
+            return false;
+        }
+    }
+}
+
+// 1. CONSTRUCTOR
+CommandLine::CommandLine(G4int defaultThreads)
+: fThreads(defaultThreads),
+  fSeed(0),
+  fEventModulo(0),
+  fSeedOncePerBatch(false),
+  fGrainSize(0),
+  fRunManagerType(G4RunManagerType::Default),
+  fInteractive(false),
+  fHelp(false)
+{}
+
+// 2. LECTURA DE ARGUMENTOS
+G4bool CommandLine::Parse(int argc, char** argv)
+{
+    for (G4int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        // Opciones que llevan valor: "--threads 8" o "--threads=8"
+        std::string value;
+        std::size_t equal = arg.find('=');
+        if (arg.compare(0, 2, "--") == 0 && equal != std::string::npos) {
+            value = arg.substr(equal + 1);
+            arg = arg.substr(0, equal);
+        }
+        auto next = [&](std::string& out) {
+            if (!value.empty()) { out = value; return true; }
+            if (i + 1 >= argc) {
+                G4cerr << "ERROR: falta el valor de " << arg << G4endl;
+                return false;
+            }
+            out = argv[++i];
+            return true;
+        };
+
+        std::string text;
+        G4long number = 0;
+        if (arg == "-h" || arg == "--help") {
+            fHelp = true;
+            PrintUsage(argv[0]);
+            return false;
+        } else if (arg == "-i" || arg == "--interactive") {
+            fInteractive = true;
+        } else if (arg == "-t" || arg == "--threads") {
+            if (!next(text)) return false;
+            if (text == "auto") {
+                fThreads = -1;
+            } else if (ParsePositive(text, number)) {
+                fThreads = G4int(number);
+            } else {
+                G4cerr << "ERROR: --threads necesita un número > 0 o auto: " << text << G4endl;
+                return false;
+            }
+        } else if (arg == "-s" || arg == "--seed") {
+            if (!next(text)) return false;
+            if (!ParsePositive(text, fSeed)) {
+                G4cerr << "ERROR: --seed necesita un entero > 0: " << text << G4endl;
+                return false;
+            }
+        } else if (arg == "-o" || arg == "--output-dir") {
+            if (!next(text)) return false;
+            fOutputDir = text;
+        } else if (arg == "-r" || arg == "--run-manager") {
+            if (!next(text)) return false;
+            if (text == "default") fRunManagerType = G4RunManagerType::Default;
+            else if (text == "serial") fRunManagerType = G4RunManagerType::Serial;
+            else if (text == "mt") fRunManagerType = G4RunManagerType::MT;
+            else if (text == "tasking") fRunManagerType = G4RunManagerType::Tasking;
+            else {
+                G4cerr << "ERROR: --run-manager debe ser default, serial, mt o tasking: " << text << G4endl;
+                return false;
+            }
+        } else if (arg == "--seed-once-per-batch") {
+            fSeedOncePerBatch = true;
+        } else if (arg == "-g" || arg == "--grain-size") {
+            if (!next(text)) return false;
+            if (!ParsePositive(text, number)) {
+                G4cerr << "ERROR: --grain-size necesita un entero > 0: " << text << G4endl;
+                return false;
+            }
+            fGrainSize = G4int(number);
+        } else if (arg == "-e" || arg == "--events-per-thread-batch") {
+            if (!next(text)) return false;
+            if (!ParsePositive(text, number)) {
+                G4cerr << "ERROR: --events-per-thread-batch necesita un entero > 0: " << text << G4endl;
+                return false;
+            }
+            fEventModulo = G4int(number);
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            G4cerr << "ERROR: opción desconocida " << arg << G4endl;
+            PrintUsage(argv[0]);
+            return false;
+        } else {
+            fMacros.push_back(arg);
+        }
+    }
+    return true;
+}
+
+void CommandLine::PrintUsage(const char* program) const
+{
+    G4cout << "Uso: " << program << " [opciones] [macro1.mac macro2.mac ...]\n"
+           << "  -t, --threads N|auto              hilos de trabajo (auto = núcleos disponibles)\n"
+           << "  -s, --seed N                      semilla del motor aleatorio\n"
+           << "  -o, --output-dir DIR              escribir las salidas en DIR (se crea si no existe)\n"
+           << "  -r, --run-manager TIPO            default, serial, mt o tasking\n"
+           << "  -e, --events-per-thread-batch N   eventos que toma cada hilo por vez\n"
+           << "      --seed-once-per-batch         sembrar una vez por lote y no por evento\n"
+           << "  -g, --grain-size N                bloques en que se reparte el run (tasking)\n"
+           << "  -i, --interactive                 abrir la sesión interactiva después de las macros\n"
+           << "  -h, --help                        esta ayuda\n"
+           << "Sin macros se abre la sesión interactiva (init_vis.mac).\n"
+           << "G4FORCENUMBEROFTHREADS, si está definida, tiene prioridad sobre --threads." << G4endl;
+}
+
+// 3. APLICAR AL RUNMANAGER
+G4bool CommandLine::Apply(G4RunManager* runManager)
+{
+    G4UImanager* UImanager = G4UImanager::GetUIpointer();
+
+    auto mtRunManager = dynamic_cast<G4MTRunManager*>(runManager);
+    auto taskRunManager = dynamic_cast<G4TaskRunManager*>(runManager);
+    G4cout << ">>> RunManager: " << (taskRunManager ? "tasking" : mtRunManager ? "mt" : "serial") << G4endl;
+
+    // Hilos: la variable de entorno la aplica Geant4 al crear el RunManager
+    const char* forced = std::getenv("G4FORCENUMBEROFTHREADS");
+    if (forced) {
+        G4cout << ">>> Hilos: G4FORCENUMBEROFTHREADS=" << forced << G4endl;
+    } else if (fThreads != 0) {
+        G4int threads = (fThreads > 0) ? fThreads : G4Threading::G4GetNumberOfCores();
+        runManager->SetNumberOfThreads(threads);
+        G4cout << ">>> Hilos: " << threads << (fThreads < 0 ? " (auto)" : "") << G4endl;
+    }
+
+    // Los workers reciben sus semillas del motor del Master
+    if (fSeed > 0) {
+        G4Random::setTheSeed(fSeed);
+        G4cout << ">>> Semilla: " << fSeed << G4endl;
+    }
+
+    // Lotes de eventos: cada hilo pide eventModulo eventos por vez al
+    // Master. Con eventos cortos (un fotón o un decaimiento) el costo de
+    // pedir y de re-sembrar por evento pesa; una semilla por lote lo evita
+    // y el resultado sigue siendo reproducible (no depende de qué hilo
+    // procesa cada lote).
+    if (fEventModulo > 0 || fSeedOncePerBatch) {
+        if (!mtRunManager) {
+            G4cerr << "WARNING: --events-per-thread-batch y --seed-once-per-batch"
+                   << " solo valen en modo MT o tasking" << G4endl;
+        } else {
+            if (fEventModulo > 0) mtRunManager->SetEventModulo(fEventModulo);
+            if (fSeedOncePerBatch) mtRunManager->SetSeedOncePerCommunication(1);
+            G4cout << ">>> Lotes: " << (fEventModulo > 0 ? std::to_string(fEventModulo) : "auto")
+                   << " eventos por hilo, semilla por " << (fSeedOncePerBatch ? "lote" : "evento") << G4endl;
+        }
+    }
+    if (fGrainSize > 0) {
+        if (taskRunManager) {
+            taskRunManager->SetGrainsize(fGrainSize);
+            G4cout << ">>> Tasking: run repartido en " << fGrainSize << " bloques" << G4endl;
+        } else {
+            G4cerr << "WARNING: --grain-size solo vale con --run-manager tasking" << G4endl;
+        }
+    }
+
+    // Directorio de salida: el proceso trabaja dentro de él. Las macros
+    // se siguen buscando donde se lanzó el programa.
+    if (!fOutputDir.empty()) {
+        std::error_code error;
+        std::filesystem::path launchDir = std::filesystem::current_path();
+        for (auto& macro : fMacros) {
+            macro = std::filesystem::absolute(std::string(macro)).string();
+        }
+        std::filesystem::create_directories(std::string(fOutputDir), error);
+        std::filesystem::current_path(std::string(fOutputDir), error);
+        if (error) {
+            G4cerr << "ERROR: no se pudo usar el directorio de salida " << fOutputDir
+                   << ": " << error.message() << G4endl;
+            return false;
+        }
+        UImanager->SetMacroSearchPath(launchDir.string());
+        G4cout << ">>> Directorio de salida: " << std::filesystem::current_path().string() << G4endl;
+    }
+    return true;
+}
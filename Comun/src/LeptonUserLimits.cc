@@ -0,0 +1,20 @@
+#include "LeptonUserLimits.hh"
+
+#include "G4Track.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+
+#include <cfloat>
+
+LeptonUserLimits::LeptonUserLimits(G4double minEkine)
+: G4UserLimits(DBL_MAX, DBL_MAX, DBL_MAX, minEkine)
+{}
+
+G4double LeptonUserLimits::GetUserMinEkine(const G4Track& track)
+{
+    const G4ParticleDefinition* particle = track.GetParticleDefinition();
+    if (particle == G4Electron::Definition() || particle == G4Positron::Definition()) {
+        return G4UserLimits::GetUserMinEkine(track);
+    }
+    return 0.;
+}
@@ -0,0 +1,20 @@
+#include "RunTimer.hh"
+
+#include "G4Run.hh"
+
+void RunTimer::Start()
+{
+    fTimer.Start();
+}
+
+void RunTimer::Stop(const G4Run* run)
+{
+    fTimer.Stop();
+    if (run->GetNumberOfEvent() <= 0) return;
+
+    G4double seconds = fTimer.GetRealElapsed();
+    G4cout << ">>> [Master] Run " << run->GetRunID() << ": "
+           << run->GetNumberOfEvent() << " eventos en " << seconds << " s ("
+           << (seconds > 0. ? run->GetNumberOfEvent() / seconds : 0.)
+           << " eventos/s)" << G4endl;
+}
@@ -18,15 +18,23 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     virtual ~DetectorConstruction();
 
     virtual G4VPhysicalVolume* Construct();
+    virtual void ConstructSDandField(); // Scorer "Detector/eDep" en el cristal
     
     // --- NUEVA FUNCIÓN (AQUÍ ESTABA EL ERROR 2) ---
     // Debes declarar la función aquí para que el .cc sepa que pertenece a la clase
     void SetREEConcentration(G4double fraction);
-    // NUEVO: Función para que el SteppingAction sepa cuál es el detector
+    // Volumen del detector (lleva el detector sensible)
     G4LogicalVolume* GetScoringVolume() const { return fLogicDetector; }
+    G4double GetREEConcentration() const { return fREEFraction; }
+
+    // Regiones (/MedidorTR/regions/): Mundo (región por defecto), Sample y
+    // Detector, cada una con su corte de producción y energía mínima.
+    // El corte del mundo es el corte por defecto que aplica el PhysicsList.
+    G4double GetWorldCut() const { return fCutWorld; }
 
   private:
     void DefineMaterials();
+    void ConstructRegions();
 
     // Volúmenes lógicos que queremos manipular
     G4LogicalVolume* fLogicSample; 
@@ -37,6 +45,10 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     G4double            fREEFraction;    // La variable de concentración
     // NUEVO: Variable para guardar el detector
     G4LogicalVolume* fLogicDetector;
+
+    G4GenericMessenger* fRegionMessenger;
+    G4double fCutWorld, fCutSample, fCutDetector;    // Cortes de producción
+    G4double fEminWorld, fEminSample, fEminDetector; // G4UserLimits: energía mínima
 };
 
 #endif
\ No newline at end of file
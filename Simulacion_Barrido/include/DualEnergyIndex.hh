@@ -0,0 +1,63 @@
+#ifndef DualEnergyIndex_h
+#define DualEnergyIndex_h 1
+
+#include "RoiCounter.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Run;
+class G4GenericMessenger;
+
+// Índice dual-energy calculado en línea (/MedidorTR/index/...).
+// Mismo método que analisis_dual.cpp: T = N / N(0% REE) en la ventana de
+// la fuente, L = -ln T, y R = L(Am-241) / L(Na-22) a igual concentración.
+//
+// Cada punto del barrido es un run (o un proceso, en run_scan.sh) con una
+// sola fuente, así que la fuente se indica con /MedidorTR/index/setSource y
+// las tasas de cada (fuente, REE) se guardan en un archivo de estado. Con
+// eso el Master calcula T, L y el Z-score contra 0% REE apenas termina el
+// run, y R cuando ya existe el mismo punto de la otra fuente.
+//
+// Las tasas son cuentas BRUTAS en la ventana de la fuente: no se resta
+// fondo de bandas laterales, así que el continuo Compton bajo el pico
+// entra en T.
+//
+// Apagado por defecto (escribe Indice_estado.txt e Indice_resultados.csv):
+// se enciende con /MedidorTR/index/enable true (scan_ree.mac, run_scan.sh).
+class DualEnergyIndex
+{
+  public:
+    DualEnergyIndex();
+    ~DualEnergyIndex();
+
+    void Fill(G4double edep, G4double weight = 1.);
+    void EndOfRun(const G4Run* run, G4double reeFraction, const G4String& fileName);
+
+    void SetSource(G4String source);
+    void SetWindowLow(G4double eMinKeV, G4double eMaxKeV);
+    void SetWindowHigh(G4double eMinKeV, G4double eMaxKeV);
+
+  private:
+    // Cuentas brutas en la ventana por evento simulado, de una fuente a una concentración
+    struct Entry { G4int source; G4double ree; G4double rate; G4double error; };
+
+    void UpdateROIs();
+    void LoadState();
+    void SaveState() const;
+    const Entry* Find(G4int source, G4double ree) const;
+
+    G4GenericMessenger* fMessenger;
+    RoiCounter fCounter;  // G4Accumulable: ventana baja (0) y alta (1)
+
+    G4bool   fEnabled;
+    G4int    fSource;             // 0 = baja (Am-241), 1 = alta (Na-22), -1 = sin definir
+    G4double fLowMin, fLowMax;    // Ventana de 59.5 keV
+    G4double fHighMin, fHighMax;  // Ventana de 511 keV
+    G4String fStateFile;
+    G4String fResultsFile;
+
+    std::vector<Entry> fEntries;
+};
+
+#endif
@@ -4,20 +4,21 @@
 #include "G4UserEventAction.hh"
 #include "globals.hh" // <--- CORREGIDO
 
+class RunAction;
+
 class EventAction : public G4UserEventAction
 {
   public:
-    EventAction();
+    EventAction(RunAction* runAction);
     virtual ~EventAction();
 
     virtual void BeginOfEventAction(const G4Event*);
     virtual void EndOfEventAction(const G4Event*);
 
-    // Función para acumular energía (llamada por SteppingAction)
-    void AddEdep(G4double edep) { fEdep += edep; }
-
   private:
-    G4double fEdep; // Variable para sumar energía total del evento
+    RunAction* fRunAction;       // Tipo de salida y contadores de ROI
+    G4int    fEdepHCID; // Colección "Detector/eDep" (se busca una vez)
+    G4double fEdep;     // Variable para sumar energía total del evento
 };
 
 #endif
\ No newline at end of file
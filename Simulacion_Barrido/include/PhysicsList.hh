@@ -3,6 +3,8 @@
 
 #include "G4VModularPhysicsList.hh" // <--- CAMBIO IMPORTANTE
 
+class G4GenericMessenger;
+
 class PhysicsList: public G4VModularPhysicsList // <--- CAMBIO DE HERENCIA
 {
   public:
@@ -11,6 +13,15 @@ class PhysicsList: public G4VModularPhysicsList // <--- CAMBIO DE HERENCIA
 
   public:
     virtual void SetCuts();
+
+    // Transporte rápido en la muestra (/MedidorTR/fast/enable, antes de
+    // /run/initialize): registra G4FastSimulationPhysics y el
+    // DetectorConstruction crea el SampleFastModel
+    void EnableFastSimulation(G4bool enable);
+    static G4bool IsFastSimulationEnabled();
+
+  private:
+    G4GenericMessenger* fMessenger;
 };
 
 #endif
\ No newline at end of file
@@ -4,8 +4,13 @@
 #include "G4UserRunAction.hh"
 #include "G4AnalysisManager.hh"
 #include "globals.hh"
+#include "RunTimer.hh"
+#include "RoiCounter.hh"
+#include "DualEnergyIndex.hh"
+#include "DetectorResponse.hh"
 
 class G4Run;
+class G4GenericMessenger;
 
 class RunAction : public G4UserRunAction
 {
@@ -15,6 +20,40 @@ class RunAction : public G4UserRunAction
 
     virtual void BeginOfRunAction(const G4Run*);
     virtual void   EndOfRunAction(const G4Run*);
+
+    // Salida (/MedidorTR/output/): histograma H1 por hilo, fusionado al
+    // final del run (por defecto), y/o la NTuple con una fila por evento
+    G4bool IsHistoOutput() const  { return fHistoOutput; }
+    G4bool IsNtupleOutput() const { return fNtupleOutput; }
+
+    // Resolución y canalización del MCA (/MedidorTR/response/), por hilo
+    const DetectorResponse& GetDetectorResponse() const { return fResponse; }
+
+    // ROIs de energía (/MedidorTR/roi/add <Emin> <Emax>, en keV). Las
+    // llena el EventAction; el Master escribe <archivo>_ROI.csv al final.
+    void AddROI(G4double eMinKeV, G4double eMaxKeV);
+    void ClearROIs();
+    void FillROI(G4double edep)
+    {
+        fROI.Fill(0, edep);
+        fIndex.Fill(edep);
+    }
+
+  private:
+    void WriteROISummary(const G4Run* run) const;
+
+    RunTimer fTimer; // Rendimiento del run (eventos/s, solo Master)
+    DetectorResponse fResponse; // Smearing + canal del ADC
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fHistoOutput;  // Llenar el H1 "Energy" (un bin por canal)
+    G4bool   fNtupleOutput; // Llenar la NTuple "Scoring" (una fila por evento)
+    G4int    fHistoBins;    // Número de bins del H1
+    G4double fHistoEmax;    // Energía máxima del H1 (mínima = 0)
+
+    G4GenericMessenger* fROIMessenger;
+    RoiCounter          fROI; // G4Accumulable: cuentas y sum(w^2) por ROI
+    DualEnergyIndex     fIndex; // T, L, Z y R (/MedidorTR/index/)
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef SampleFastModel_h
+#define SampleFastModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "globals.hh"
+
+#include <map>
+#include <utility>
+
+class G4Material;
+class G4GenericMessenger;
+
+// Transporte rápido de fotones en la muestra (región "Sample", ver
+// DetectorConstruction). Al entrar, el punto de interacción se muestrea de
+// Beer-Lambert con el coeficiente de atenuación total del material:
+//  - sin colisión: el fotón sale directamente por la cara opuesta;
+//  - con colisión: el primario termina ahí. Si transportScattered está
+//    activo, un Compton o Rayleigh produce el fotón dispersado, que sigue
+//    con el transporte completo; fotoeléctrico y pares lo absorben.
+// Las secciones eficaces totales son las de option4 (Livermore/Monash),
+// tabuladas en una grilla logarítmica de energía e interpoladas. Las
+// distribuciones angulares NO: Klein-Nishina de electrón libre y Thomson
+// sin factor de forma. Eso sesga la dispersión hacia adelante a bajas
+// energías, así que el modelo queda fuera de scan_ree.mac hasta tener una
+// comparación contra el transporte completo.
+// Solo existe con /MedidorTR/fast/enable true (PhysicsList).
+class SampleFastModel : public G4VFastSimulationModel
+{
+  public:
+    SampleFastModel(const G4String& name, G4Region* envelope);
+    virtual ~SampleFastModel();
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+    virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+    virtual void   DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+  private:
+    // Coeficientes lineales (1/longitud) por proceso
+    struct CrossSections { G4double compton, rayleigh, total; };
+    const CrossSections& GetCrossSections(const G4Material* material, G4double energy);
+
+    G4double SampleKleinNishina(G4double energy, G4double& cosTheta) const;
+    G4double SampleThomson() const;
+
+    const CrossSections& GetNode(const G4Material* material, G4int node);
+
+    G4GenericMessenger* fMessenger;
+    G4bool fTransportScattered;
+
+    // Nodos de la grilla (material, índice): acotado aunque los fotones
+    // dispersados entren con energías continuas
+    std::map<std::pair<const G4Material*, G4int>, CrossSections> fCache;
+    CrossSections fInterpolated;
+};
+
+#endif
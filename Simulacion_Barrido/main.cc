@@ -6,19 +6,24 @@
 #include "DetectorConstruction.hh"
 #include "PhysicsList.hh"
 #include "ActionInitialization.hh" // <--- Usamos la nueva clase
+#include "CommandLine.hh"
 
 int main(int argc, char** argv)
 {
-  // 1. Detectar modo (Interactivo o Batch)
+  // 1. Línea de comandos y modo (Interactivo o Batch)
+  // Por defecto 16 hilos, como antes; --threads auto usa todos los núcleos
+  CommandLine options(16);
+  if (!options.Parse(argc, argv)) return options.IsHelp() ? 0 : 1;
+
   G4UIExecutive* ui = nullptr;
-  if (argc == 1) { ui = new G4UIExecutive(argc, argv); }
+  if (options.IsInteractive()) { ui = new G4UIExecutive(argc, argv); }
 
   // 2. Crear RunManager
-  // Si compilaste con MT, esto crea un G4MTRunManager automáticamente
-  auto* runManager = G4RunManagerFactory::CreateRunManager();
-  
-  // Opcional: Forzar número de hilos si quieres (ej. 16)
-  runManager->SetNumberOfThreads(16); 
+  // Tipo con --run-manager; por defecto el de Geant4 (G4RUN_MANAGER_TYPE)
+  auto* runManager = G4RunManagerFactory::CreateRunManager(options.GetRunManagerType());
+
+  // Hilos, semilla, lotes de eventos y directorio de salida
+  if (!options.Apply(runManager)) { delete ui; delete runManager; return 1; }
 
   // 3. Inicializar Clases Obligatorias
   runManager->SetUserInitialization(new DetectorConstruction());
@@ -34,15 +39,14 @@ int main(int argc, char** argv)
   // 6. Interfaz de Usuario
   G4UImanager* UImanager = G4UImanager::GetUIpointer();
 
-  if ( ! ui ) {
-    // Modo Batch (ejecutar macro y salir)
-    G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command+fileName);
+  // Modo Batch: las macros en orden (y salir, salvo --interactive)
+  for (const auto& fileName : options.GetMacros()) {
+    UImanager->ApplyCommand("/control/execute " + fileName);
   }
-  else {
+
+  if ( ui ) {
     // Modo Interactivo (abrir ventana gráfica)
-    UImanager->ApplyCommand("/control/execute init_vis.mac");
+    if (options.GetMacros().empty()) UImanager->ApplyCommand("/control/execute init_vis.mac");
     ui->SessionStart();
     delete ui;
   }
@@ -3,6 +3,12 @@
 
 echo "=== INICIO DEL BARRIDO REE ==="
 
+# Cada punto es un proceso: el índice dual se arma con Indice_estado.txt
+rm -f Indice_estado.txt Indice_resultados.csv
+
+# Hilos por simulación (número o auto = todos los núcleos del nodo)
+THREADS=${THREADS:-16}
+
 # Am-241 (59.5 keV)
 for ree in 0.0 0.01 0.02 0.03 0.04 0.05; do
     echo ">>> Ejecutando Am241 con REE = $ree"
@@ -17,12 +23,15 @@ for ree in 0.0 0.01 0.02 0.03 0.04 0.05; do
 /gps/pos/centre 0. 0. -10. cm
 /gps/direction 0 0 1
 /gps/ene/mono 59.5 keV
+/MedidorTR/index/enable true
+/MedidorTR/index/setSource low
 /analysis/setFileName Am241_${ree_name}_REE.root
 /MedidorTR/det/setREE ${ree}
+/MedidorTR/response/enable true
 /run/beamOn 10000000
 EOF
     
-    ./Simulacion_Barrido temp_run.mac
+    ./Simulacion_Barrido --threads $THREADS temp_run.mac
     
     if [ $? -ne 0 ]; then
         echo "ERROR en Am241 REE=$ree"
@@ -43,12 +52,15 @@ for ree in 0.0 0.01 0.02 0.03 0.04 0.05; do
 /gps/pos/centre 0. 0. -10. cm
 /gps/direction 0 0 1
 /gps/ene/mono 511. keV
+/MedidorTR/index/enable true
+/MedidorTR/index/setSource high
 /analysis/setFileName Na22_${ree_name}_REE.root
 /MedidorTR/det/setREE ${ree}
+/MedidorTR/response/enable true
 /run/beamOn 10000000
 EOF
     
-    ./Simulacion_Barrido temp_run.mac
+    ./Simulacion_Barrido --threads $THREADS temp_run.mac
     
     if [ $? -ne 0 ]; then
         echo "ERROR en Na22 REE=$ree"
@@ -2,7 +2,6 @@
 #include "PrimaryGeneratorAction.hh"
 #include "RunAction.hh"
 #include "EventAction.hh"
-#include "SteppingAction.hh"
 #include "DetectorConstruction.hh"
 
 ActionInitialization::ActionInitialization()
@@ -22,10 +21,12 @@ void ActionInitialization::BuildForMaster() const
 void ActionInitialization::Build() const
 {
     SetUserAction(new PrimaryGeneratorAction);
-    SetUserAction(new RunAction());  // Workers también necesitan uno
+
+    RunAction* runAction = new RunAction();  // Workers también necesitan uno
+    SetUserAction(runAction);
     
-    EventAction* eventAction = new EventAction();
+    EventAction* eventAction = new EventAction(runAction);
     SetUserAction(eventAction);
-    
-    SetUserAction(new SteppingAction(nullptr)); 
+
+    // Sin SteppingAction: el scoring lo hace el detector sensible
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "DetectorConstruction.hh"
+#include "SampleFastModel.hh"
+#include "PhysicsList.hh"
 
 #include "G4RunManager.hh"
 #include "G4NistManager.hh"
@@ -10,6 +12,14 @@
 #include "G4VisAttributes.hh"
 #include "G4Color.hh"
 #include "G4GenericMessenger.hh" 
+#include "G4SDManager.hh"
+#include "G4MultiFunctionalDetector.hh"
+#include "G4PSEnergyDeposit.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "LeptonUserLimits.hh"
+
 
 // 1. CONSTRUCTOR
 DetectorConstruction::DetectorConstruction()
@@ -17,7 +27,14 @@ DetectorConstruction::DetectorConstruction()
   fREEFraction(0.0), 
   fApatiteWithREE(nullptr),
   fLogicSample(nullptr),
-  fLogicDetector(nullptr) // <--- AÑADE ESTO (Inicializar a nulo)
+  fLogicDetector(nullptr), // <--- AÑADE ESTO (Inicializar a nulo)
+  fRegionMessenger(nullptr),
+  fCutWorld(10.0*cm),
+  fCutSample(1.0*mm),
+  fCutDetector(0.1*mm),
+  fEminWorld(10.0*keV),
+  fEminSample(10.0*keV),
+  fEminDetector(0.)
 {
     // Crear el mensajero
     fMessenger = new G4GenericMessenger(this, "/MedidorTR/det/", "Control del Detector");
@@ -29,11 +46,39 @@ DetectorConstruction::DetectorConstruction()
     fMessenger->DeclareMethod("setREE", 
                               &DetectorConstruction::SetREEConcentration, 
                               "Set REE concentration (mass fraction 0.0 - 1.0)");
+
+    // Regiones: se fijan antes de /run/initialize (la geometría es del Master)
+    fRegionMessenger = new G4GenericMessenger(this, "/MedidorTR/regions/", "Cortes por región");
+    fRegionMessenger->DeclarePropertyWithUnit("cutWorld", "mm", fCutWorld,
+                                              "Corte de producción en el aire del mundo")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fRegionMessenger->DeclarePropertyWithUnit("cutSample", "mm", fCutSample,
+                                              "Corte de producción en la muestra")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fRegionMessenger->DeclarePropertyWithUnit("cutDetector", "mm", fCutDetector,
+                                              "Corte de producción en el cristal")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fRegionMessenger->DeclarePropertyWithUnit("eminWorld", "keV", fEminWorld,
+                                              "Energía mínima de las cargadas en el mundo")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fRegionMessenger->DeclarePropertyWithUnit("eminSample", "keV", fEminSample,
+                                              "Energía mínima de las cargadas en la muestra")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fRegionMessenger->DeclarePropertyWithUnit("eminDetector", "keV", fEminDetector,
+                                              "Energía mínima de las cargadas en el cristal")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
 }
 
 // 2. DESTRUCTOR
 DetectorConstruction::~DetectorConstruction()
 {
+    delete fRegionMessenger;
     delete fMessenger; 
 }
 
@@ -111,6 +156,9 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                       0, 
                       true);
 
+    // --- C2. REGIONES ---
+    ConstructRegions();
+
     // --- D. VISUALIZACIÓN ---
     G4VisAttributes* sampleVis = new G4VisAttributes(G4Color(0.0, 1.0, 1.0, 0.6)); // Cyan
     sampleVis->SetForceSolid(true);
@@ -123,7 +171,25 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
     return physWorld; 
 }
 
-// 4. DEFINICIÓN DE MATERIALES (Tu código, con pequeña optimización)
+// 4. DETECTOR SENSIBLE Y FAST SIMULATION
+// Se llama en cada hilo. El scorer de energía depositada solo se ejecuta
+// en los pasos dentro del cristal: el aire y la muestra no pasan por
+// código de usuario.
+void DetectorConstruction::ConstructSDandField()
+{
+    auto detector = new G4MultiFunctionalDetector("Detector");
+    G4SDManager::GetSDMpointer()->AddNewDetector(detector);
+    detector->RegisterPrimitive(new G4PSEnergyDeposit("eDep"));
+    SetSensitiveDetector(fLogicDetector, detector);
+
+    // Transporte rápido de fotones en la muestra (apagado por defecto,
+    // /MedidorTR/fast/enable). La región "Sample" es la envolvente.
+    if (!PhysicsList::IsFastSimulationEnabled()) return;
+    G4Region* sample = G4RegionStore::GetInstance()->GetRegion("Sample", false);
+    if (sample) new SampleFastModel("SampleFastModel", sample);
+}
+
+// 5. DEFINICIÓN DE MATERIALES (Tu código, con pequeña optimización)
 void DetectorConstruction::DefineMaterials() {
     G4NistManager* nist = G4NistManager::Instance();
 
@@ -203,7 +269,7 @@ void DetectorConstruction::DefineMaterials() {
     }
 }
 
-// 5. UPDATE
+// 6. UPDATE
 void DetectorConstruction::SetREEConcentration(G4double fraction) {
     fREEFraction = fraction;
     DefineMaterials(); 
@@ -211,4 +277,38 @@ void DetectorConstruction::SetREEConcentration(G4double fraction) {
     // CAMBIO CRÍTICO: Usar ReinitializeGeometry en lugar de GeometryHasBeenModified
     // Esto fuerza una reconstrucción completa incluyendo las tablas de física
     //G4RunManager::GetRunManager()->ReinitializeGeometry(true, false);
-}
\ No newline at end of file
+}
+
+// 7. REGIONES
+// Fuera del cristal solo importan los fotones: con cortes grandes y una
+// energía mínima los electrones del aire y de la muestra depositan su
+// energía en el acto. El cristal conserva el corte fino para el espectro.
+// La energía mínima la aplica G4UserSpecialCuts (G4StepLimiterPhysics)
+// y vale solo para electrones y positrones (LeptonUserLimits).
+void DetectorConstruction::ConstructRegions()
+{
+    G4RegionStore* store = G4RegionStore::GetInstance();
+
+    G4Region* world = store->GetRegion("DefaultRegionForTheWorld", false);
+    if (world) world->SetUserLimits(new LeptonUserLimits(fEminWorld));
+
+    G4Region* sample = store->GetRegion("Sample", false);
+    if (!sample) sample = new G4Region("Sample");
+    sample->AddRootLogicalVolume(fLogicSample);
+    G4ProductionCuts* sampleCuts = new G4ProductionCuts();
+    sampleCuts->SetProductionCut(fCutSample);
+    sample->SetProductionCuts(sampleCuts);
+    sample->SetUserLimits(new LeptonUserLimits(fEminSample));
+
+    G4Region* detector = store->GetRegion("Detector", false);
+    if (!detector) detector = new G4Region("Detector");
+    detector->AddRootLogicalVolume(fLogicDetector);
+    G4ProductionCuts* detectorCuts = new G4ProductionCuts();
+    detectorCuts->SetProductionCut(fCutDetector);
+    detector->SetProductionCuts(detectorCuts);
+    detector->SetUserLimits(new LeptonUserLimits(fEminDetector));
+
+    G4cout << "--> Regiones: mundo " << fCutWorld/mm << " mm / " << fEminWorld/keV
+           << " keV, muestra " << fCutSample/mm << " mm / " << fEminSample/keV
+           << " keV, detector " << fCutDetector/mm << " mm / " << fEminDetector/keV << " keV" << G4endl;
+}
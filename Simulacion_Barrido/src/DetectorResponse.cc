@@ -0,0 +1,64 @@
+#include "DetectorResponse.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+
+// 1. CONSTRUCTOR
+// Valores por defecto: ~3% FWHM a 662 keV, dominado por la estadística
+// de fotoelectrones (b*sqrt(662) = 19.9 keV). Apagado por defecto para
+// no cambiar los espectros de los análisis que ya aplican su smearing.
+DetectorResponse::DetectorResponse()
+: fMessenger(nullptr),
+  fEnabled(false),
+  fA(0.),
+  fB(0.772),
+  fC(0.),
+  fChannels(1024),
+  fChannelEmax(1600.*keV)
+{
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/response/", "Resolución del detector y MCA");
+    fMessenger->DeclareProperty("enable", fEnabled,
+                                "Aplicar la resolución y la canalización al llenar H1, NTuple y ROIs");
+    fMessenger->DeclareProperty("fwhmA", fA,
+                                "Término constante de FWHM(E) = a + b*sqrt(E) + c*E, en keV");
+    fMessenger->DeclareProperty("fwhmB", fB,
+                                "Término estadístico b, en keV^(1/2) (0.772 -> 3% a 662 keV)");
+    fMessenger->DeclareProperty("fwhmC", fC,
+                                "Término proporcional c (adimensional)");
+    fMessenger->DeclareProperty("channels", fChannels,
+                                "Canales del MCA (0 = sin canalizar)");
+    fMessenger->DeclarePropertyWithUnit("channelEmax", "keV", fChannelEmax,
+                                        "Energía del borde superior del último canal");
+}
+
+// 2. DESTRUCTOR
+DetectorResponse::~DetectorResponse()
+{
+    delete fMessenger;
+}
+
+// 3. RESOLUCIÓN
+G4double DetectorResponse::GetFWHM(G4double energy) const
+{
+    G4double e = energy / keV;
+    return (fA + fB * std::sqrt(e) + fC * e) * keV;
+}
+
+// 4. RESPUESTA: smearing gaussiano + canal del ADC
+G4double DetectorResponse::Apply(G4double edep) const
+{
+    if (!fEnabled) return edep;
+
+    G4double sigma = GetFWHM(edep) / 2.355;
+    G4double energy = (sigma > 0.) ? G4RandGauss::shoot(edep, sigma) : edep;
+    if (energy <= 0.) return 0.;
+    if (fChannels <= 0) return energy;
+
+    // Fuera del rango del MCA el pulso se pierde (no hay canal de overflow)
+    G4int channel = G4int(energy / fChannelEmax * fChannels);
+    if (channel >= fChannels) return 0.;
+    return (channel + 0.5) * fChannelEmax / fChannels;
+}
@@ -0,0 +1,202 @@
+#include "DualEnergyIndex.hh"
+
+#include "G4Run.hh"
+#include "G4GenericMessenger.hh"
+#include "G4AccumulableManager.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+// 1. CONSTRUCTOR
+DualEnergyIndex::DualEnergyIndex()
+: fMessenger(nullptr),
+  fCounter("SourceROI"),
+  fEnabled(false),
+  fSource(-1),
+  fLowMin(52.*keV), fLowMax(68.*keV),
+  fHighMin(490.*keV), fHighMax(532.*keV),
+  fStateFile("Indice_estado.txt"),
+  fResultsFile("Indice_resultados.csv")
+{
+    G4AccumulableManager::Instance()->RegisterAccumulable(&fCounter);
+    UpdateROIs();
+
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/index/", "Índice dual-energy en línea");
+    fMessenger->DeclareProperty("enable", fEnabled,
+                                "Calcular T, L, Z y R al final de cada run (apagado por defecto)");
+    fMessenger->DeclareMethod("setSource", &DualEnergyIndex::SetSource,
+                              "Fuente del run: low (Am-241) o high (Na-22)");
+    fMessenger->DeclareMethod("setWindowLow", &DualEnergyIndex::SetWindowLow,
+                              "Ventana de la fuente baja: <Emin> <Emax> en keV (ej. 52 68)");
+    fMessenger->DeclareMethod("setWindowHigh", &DualEnergyIndex::SetWindowHigh,
+                              "Ventana de la fuente alta: <Emin> <Emax> en keV (ej. 490 532)");
+    fMessenger->DeclareProperty("stateFile", fStateFile,
+                                "Archivo con las tasas de cada (fuente, REE) ya simulado");
+    fMessenger->DeclareProperty("resultsFile", fResultsFile,
+                                "CSV al que se agrega una fila por run");
+}
+
+// 2. DESTRUCTOR
+DualEnergyIndex::~DualEnergyIndex()
+{
+    delete fMessenger;
+}
+
+// 3. CONFIGURACIÓN
+void DualEnergyIndex::SetSource(G4String source)
+{
+    if (source == "low" || source == "Am241") {
+        fSource = 0;
+    } else if (source == "high" || source == "Na22") {
+        fSource = 1;
+    } else {
+        G4cerr << "ERROR: fuente desconocida '" << source << "' (use low o high)" << G4endl;
+    }
+}
+
+void DualEnergyIndex::SetWindowLow(G4double eMinKeV, G4double eMaxKeV)
+{
+    if (eMinKeV < 0. || eMaxKeV <= eMinKeV) {
+        G4cerr << "ERROR: ventana inválida [" << eMinKeV << ", " << eMaxKeV << "] keV" << G4endl;
+        return;
+    }
+    fLowMin = eMinKeV*keV;
+    fLowMax = eMaxKeV*keV;
+    UpdateROIs();
+}
+
+void DualEnergyIndex::SetWindowHigh(G4double eMinKeV, G4double eMaxKeV)
+{
+    if (eMinKeV < 0. || eMaxKeV <= eMinKeV) {
+        G4cerr << "ERROR: ventana inválida [" << eMinKeV << ", " << eMaxKeV << "] keV" << G4endl;
+        return;
+    }
+    fHighMin = eMinKeV*keV;
+    fHighMax = eMaxKeV*keV;
+    UpdateROIs();
+}
+
+void DualEnergyIndex::UpdateROIs()
+{
+    fCounter.Clear();
+    fCounter.AddROI(fLowMin, fLowMax);
+    fCounter.AddROI(fHighMin, fHighMax);
+}
+
+// 4. LLENADO (workers)
+void DualEnergyIndex::Fill(G4double edep, G4double weight)
+{
+    if (fEnabled) fCounter.Fill(0, edep, weight);
+}
+
+// 5. ARCHIVO DE ESTADO
+// Una línea por punto: <fuente> <REE> <tasa> <error>
+void DualEnergyIndex::LoadState()
+{
+    fEntries.clear();
+    std::ifstream file(fStateFile);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        Entry entry;
+        if (fields >> entry.source >> entry.ree >> entry.rate >> entry.error) {
+            fEntries.push_back(entry);
+        }
+    }
+}
+
+void DualEnergyIndex::SaveState() const
+{
+    std::ofstream file(fStateFile);
+    file << "# fuente(0=baja,1=alta) REE tasa error (por evento simulado)\n";
+    file.precision(12);
+    for (const auto& entry : fEntries) {
+        file << entry.source << " " << entry.ree << " " << entry.rate << " " << entry.error << "\n";
+    }
+}
+
+const DualEnergyIndex::Entry* DualEnergyIndex::Find(G4int source, G4double ree) const
+{
+    for (const auto& entry : fEntries) {
+        if (entry.source == source && std::abs(entry.ree - ree) < 1.e-9) return &entry;
+    }
+    return nullptr;
+}
+
+// 6. FIN DEL RUN (Master)
+void DualEnergyIndex::EndOfRun(const G4Run* run, G4double reeFraction, const G4String& fileName)
+{
+    G4int nEvents = run->GetNumberOfEvent();
+    if (!fEnabled || nEvents == 0) return;
+    if (fSource < 0) {
+        G4cerr << "WARNING: índice dual sin fuente. Use /MedidorTR/index/setSource low|high" << G4endl;
+        return;
+    }
+
+    // Se relee el estado: otros procesos del barrido pudieron agregar puntos
+    LoadState();
+    Entry current = {fSource, reeFraction,
+                     fCounter.GetSumW(0, fSource) / nEvents,
+                     std::sqrt(fCounter.GetSumW2(0, fSource)) / nEvents};
+    const Entry* previous = Find(fSource, reeFraction);
+    if (previous) {
+        fEntries[previous - fEntries.data()] = current;
+    } else {
+        fEntries.push_back(current);
+    }
+    SaveState();
+
+    // Transmisión y atenuación contra 0% REE de la misma fuente
+    const Entry* reference = Find(fSource, 0.);
+    G4double T = 0., errT = 0., L = 0., errL = 0., Z = 0.;
+    if (reference && reference->rate > 0. && current.rate > 0.) {
+        G4double rel = current.error / current.rate;
+        // En el punto 0% el run es su propia referencia (T = 1, L = 0)
+        G4double relRef = (reeFraction > 0.) ? reference->error / reference->rate : 0.;
+        T = current.rate / reference->rate;
+        errT = T * std::sqrt(rel*rel + relRef*relRef);
+        L = -std::log(T);
+        errL = std::sqrt(rel*rel + relRef*relRef);
+        if (errL > 0.) Z = L / errL;
+    }
+
+    // Razón dual R = L_baja / L_alta si ya existe el punto de la otra fuente
+    G4double R = 0., errR = 0.;
+    G4bool hasR = false;
+    const Entry* lowEntry = Find(0, reeFraction);
+    const Entry* highEntry = Find(1, reeFraction);
+    const Entry* lowRef = Find(0, 0.);
+    const Entry* highRef = Find(1, 0.);
+    if (reeFraction > 0. && lowEntry && highEntry && lowRef && highRef
+        && lowEntry->rate > 0. && highEntry->rate > 0. && lowRef->rate > 0. && highRef->rate > 0.) {
+        G4double Llow = -std::log(lowEntry->rate / lowRef->rate);
+        G4double Lhigh = -std::log(highEntry->rate / highRef->rate);
+        G4double errLlow = std::sqrt(std::pow(lowEntry->error/lowEntry->rate, 2)
+                                     + std::pow(lowRef->error/lowRef->rate, 2));
+        G4double errLhigh = std::sqrt(std::pow(highEntry->error/highEntry->rate, 2)
+                                      + std::pow(highRef->error/highRef->rate, 2));
+        if (Llow != 0. && Lhigh != 0.) {
+            R = Llow / Lhigh;
+            errR = std::abs(R) * std::sqrt(std::pow(errLlow/Llow, 2) + std::pow(errLhigh/Lhigh, 2));
+            hasR = true;
+        }
+    }
+
+    G4bool newFile = !std::ifstream(fResultsFile).good();
+    std::ofstream csv(fResultsFile, std::ios::app);
+    if (newFile) {
+        csv << "archivo,fuente,REE,eventos,N,errN,T,errT,L,errL,Z_score,R,errR\n";
+    }
+    csv << fileName << "," << (fSource == 0 ? "low" : "high") << "," << reeFraction << ","
+        << nEvents << "," << current.rate * nEvents << "," << current.error * nEvents << ","
+        << T << "," << errT << "," << L << "," << errL << "," << Z << ","
+        << R << "," << errR << "\n";
+
+    G4cout << ">>> [Master] Indice (" << (fSource == 0 ? "low" : "high") << ", REE = "
+           << reeFraction << "): T = " << T << " +/- " << errT << " | Z = " << Z;
+    if (hasR) G4cout << " | R = " << R << " +/- " << errR;
+    G4cout << G4endl;
+}
@@ -2,26 +2,73 @@
 #include "G4EmStandardPhysics_option4.hh"
 #include "G4DecayPhysics.hh"
 #include "G4RadioactiveDecayPhysics.hh"
+#include "G4StepLimiterPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
 #include "G4SystemOfUnits.hh" // <--- FALTABA ESTO PARA LEER 'mm'
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "DetectorConstruction.hh"
+
+namespace
+{
+    // Lo consulta el DetectorConstruction en cada hilo (ConstructSDandField)
+    G4bool fastSimulationEnabled = false;
+}
 
 PhysicsList::PhysicsList() 
-: G4VModularPhysicsList() // <--- CAMBIO A MODULAR
+: G4VModularPhysicsList(), // <--- CAMBIO A MODULAR
+  fMessenger(nullptr)
 {
   // Ahora sí podemos usar RegisterPhysics porque somos una G4VModularPhysicsList
   RegisterPhysics(new G4EmStandardPhysics_option4());
   RegisterPhysics(new G4DecayPhysics());
   RegisterPhysics(new G4RadioactiveDecayPhysics());
+
+  // G4UserLimits de las regiones (energía mínima de las cargadas)
+  RegisterPhysics(new G4StepLimiterPhysics());
+
+  // La fast simulation solo se registra si se pide (EnableFastSimulation)
+  fMessenger = new G4GenericMessenger(this, "/MedidorTR/fast/", "Transporte rápido en la muestra");
+  fMessenger->DeclareMethod("enable", &PhysicsList::EnableFastSimulation,
+                            "Beer-Lambert analítico en la muestra (antes de /run/initialize)")
+      .SetToBeBroadcasted(false)
+      .SetStates(G4State_PreInit);
 }
 
 PhysicsList::~PhysicsList()
 { 
+  delete fMessenger;
+}
+
+// Fast simulation de gammas (SampleFastModel en la muestra). Una vez
+// registrada no se puede quitar: false solo sirve antes de registrarla.
+void PhysicsList::EnableFastSimulation(G4bool enable)
+{
+  if (!enable) {
+    if (fastSimulationEnabled) G4cerr << "WARNING: la fast simulation ya está registrada" << G4endl;
+    return;
+  }
+  if (fastSimulationEnabled) return;
+
+  G4FastSimulationPhysics* fastSimulation = new G4FastSimulationPhysics();
+  fastSimulation->ActivateFastSimulation("gamma");
+  RegisterPhysics(fastSimulation);
+  fastSimulationEnabled = true;
+}
+
+G4bool PhysicsList::IsFastSimulationEnabled()
+{
+  return fastSimulationEnabled;
 }
 
 void PhysicsList::SetCuts()
 {
   // Definir el rango de corte de producción (Production Cut)
-  // Esto dice: "No generes partículas secundarias si viajan menos de 0.1 mm"
-  SetDefaultCutValue(0.1*mm); 
+  // El corte por defecto es el del mundo (/MedidorTR/regions/cutWorld);
+  // la muestra y el cristal tienen el suyo en su G4Region
+  auto detector = static_cast<const DetectorConstruction*>
+      (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  SetDefaultCutValue(detector ? detector->GetWorldCut() : 0.1*mm); 
 
   // Aplicar los cortes a las tablas de física
   G4VModularPhysicsList::SetCuts();
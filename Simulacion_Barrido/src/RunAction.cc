@@ -1,45 +1,168 @@
 #include "RunAction.hh"
+#include "DetectorConstruction.hh"
+#include "G4RunManager.hh"
 #include "G4Run.hh"
 #include "G4AnalysisManager.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4Threading.hh" 
+#include "G4GenericMessenger.hh"
+#include "G4AccumulableManager.hh"
+
+#include <cmath>
+#include <fstream>
 
 RunAction::RunAction()
-: G4UserRunAction()
+: G4UserRunAction(),
+  fMessenger(nullptr),
+  fHistoOutput(true),
+  fNtupleOutput(false),
+  fHistoBins(1600),
+  fHistoEmax(1600.*keV),
+  fROIMessenger(nullptr),
+  fROI("ROI")
 {
     auto analysisManager = G4AnalysisManager::Instance();
     analysisManager->SetDefaultFileType("root");
     analysisManager->SetVerboseLevel(1);
     analysisManager->SetNtupleMerging(true);
+    analysisManager->SetActivation(true); // La NTuple se apaga con /MedidorTR/output/ntuple false
     
     if (G4Threading::IsMasterThread()) {
         G4cout << ">>> [Master] RunAction iniciado. Merging activado." << G4endl;
     }
+
+    // Tipo de salida: el Master y los workers deben tener los mismos bins
+    // para fusionar los histogramas (los comandos se reenvían a los hilos)
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/output/", "Salida de la simulación");
+    fMessenger->DeclareProperty("histo", fHistoOutput,
+                                "Llenar el histograma Energy (tamaño fijo, no crece con los eventos)");
+    fMessenger->DeclareProperty("ntuple", fNtupleOutput,
+                                "Llenar la NTuple Scoring (una fila por evento con depósito)");
+    fMessenger->DeclareProperty("histoBins", fHistoBins,
+                                "Número de bins del histograma Energy");
+    fMessenger->DeclarePropertyWithUnit("histoEmax", "keV", fHistoEmax,
+                                        "Energía máxima del histograma Energy");
+
+    // ROIs: los workers las llenan y el Master las fusiona
+    G4AccumulableManager::Instance()->RegisterAccumulable(&fROI);
+    fROIMessenger = new G4GenericMessenger(this, "/MedidorTR/roi/", "Regiones de interés en energía");
+    fROIMessenger->DeclareMethod("add", &RunAction::AddROI,
+                                 "Agregar una ROI: <Emin> <Emax> en keV (ej. 52 68)");
+    fROIMessenger->DeclareMethod("clear", &RunAction::ClearROIs,
+                                 "Borrar todas las ROIs");
 }
 
 RunAction::~RunAction()
-{}
+{
+    delete fROIMessenger;
+    delete fMessenger;
+}
+
+void RunAction::AddROI(G4double eMinKeV, G4double eMaxKeV)
+{
+    if (eMinKeV < 0. || eMaxKeV <= eMinKeV) {
+        G4cerr << "ERROR: ROI inválida [" << eMinKeV << ", " << eMaxKeV << "] keV" << G4endl;
+        return;
+    }
+    fROI.AddROI(eMinKeV*keV, eMaxKeV*keV);
+}
+
+void RunAction::ClearROIs()
+{
+    fROI.Clear();
+}
 
 void RunAction::BeginOfRunAction(const G4Run*)
 {
+    G4AccumulableManager::Instance()->Reset();
+
     auto analysisManager = G4AnalysisManager::Instance();
     
-    // Crear NTuple SOLO si no existe (primera vez o después de Reset)
-    if (analysisManager->GetNofNtuples() == 0) {
+    // Crear NTuple SOLO si se pide (/MedidorTR/output/ntuple true) y no
+    // existe (primera vez o después de Reset)
+    if (fNtupleOutput && analysisManager->GetNofNtuples() == 0) {
         analysisManager->CreateNtuple("Scoring", "Datos por Evento");
         analysisManager->CreateNtupleDColumn("Energy");
         analysisManager->FinishNtuple();
     }
+    // Creada en un run anterior: sin salida pedida no se llena, fusiona
+    // ni escribe (árbol vacío)
+    if (analysisManager->GetNofNtuples() > 0) analysisManager->SetNtupleActivation(fNtupleOutput);
+
+    // Histograma de energía depositada (keV). Los análisis de Resultados*
+    // ya buscan "Energy" y detectan la unidad por el rango del eje.
+    // Si ya existe se actualizan los bins (pueden cambiar entre runs).
+    // Con el MCA activo, un bin por canal.
+    G4int bins = fHistoBins;
+    G4double eMax = fHistoEmax;
+    if (fResponse.GetChannels() > 0) {
+        bins = fResponse.GetChannels();
+        eMax = fResponse.GetChannelEmax();
+    }
+    if (analysisManager->GetNofH1s() == 0) {
+        analysisManager->CreateH1("Energy", "Energia depositada", bins, 0., eMax, "keV");
+    } else {
+        analysisManager->SetH1(0, bins, 0., eMax, "keV");
+    }
     
     // Abrir archivo
     analysisManager->OpenFile();
+
+    if (IsMaster() && fResponse.IsEnabled()) {
+        G4cout << ">>> [Master] Resolución: FWHM(662 keV) = "
+               << fResponse.GetFWHM(662.*keV)/keV << " keV, "
+               << fResponse.GetChannels() << " canales" << G4endl;
+    }
+
+    if (IsMaster()) fTimer.Start();
 }
 
-void RunAction::EndOfRunAction(const G4Run*)
+void RunAction::EndOfRunAction(const G4Run* run)
 {
     auto analysisManager = G4AnalysisManager::Instance();
     analysisManager->Write();
     analysisManager->CloseFile();
+
+    // ROIs: en el Master, Merge() suma los contadores de todos los hilos
+    G4AccumulableManager::Instance()->Merge();
+    if (IsMaster()) WriteROISummary(run);
+
+    // Índice dual-energy: una fila por run en el CSV de resultados
+    if (IsMaster()) {
+        auto detector = static_cast<const DetectorConstruction*>
+            (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+        fIndex.EndOfRun(run, detector->GetREEConcentration(), analysisManager->GetFileName());
+    }
+
+    // Rendimiento: tiempo real de todo el run (todos los hilos)
+    if (IsMaster()) fTimer.Stop(run);
     
     // NO usar Reset() aquí - causa problemas entre runs consecutivos
-}
\ No newline at end of file
+}
+
+// Resumen compacto: cuentas ± error por ROI, más los eventos simulados.
+// Alcanza para las curvas de transmisión sin releer el .root.
+void RunAction::WriteROISummary(const G4Run* run) const
+{
+    if (fROI.GetNumberOfROIs() == 0 || run->GetNumberOfEvent() == 0) return;
+
+    G4String fileName = G4AnalysisManager::Instance()->GetFileName();
+    if (fileName.size() > 5 && fileName.substr(fileName.size() - 5) == ".root") {
+        fileName = fileName.substr(0, fileName.size() - 5);
+    }
+    fileName += "_ROI.csv";
+
+    std::ofstream file(fileName);
+    file << "# eventos: " << run->GetNumberOfEvent() << "\n";
+    file << "Emin_keV,Emax_keV,cuentas,error\n";
+
+    G4cout << ">>> [Master] ROIs (" << run->GetNumberOfEvent() << " eventos) -> " << fileName << G4endl;
+    for (std::size_t roi = 0; roi < fROI.GetNumberOfROIs(); roi++) {
+        G4double counts = fROI.GetSumW(0, roi);
+        G4double error = std::sqrt(fROI.GetSumW2(0, roi));
+        file << fROI.GetEmin(roi)/keV << "," << fROI.GetEmax(roi)/keV
+             << "," << counts << "," << error << "\n";
+        G4cout << "    [" << fROI.GetEmin(roi)/keV << ", " << fROI.GetEmax(roi)/keV
+               << "] keV: " << counts << " +/- " << error << G4endl;
+    }
+}
@@ -0,0 +1,181 @@
+#include "SampleFastModel.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Track.hh"
+#include "G4Gamma.hh"
+#include "G4DynamicParticle.hh"
+#include "G4EmCalculator.hh"
+#include "G4GenericMessenger.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    // Grilla logarítmica de energía: 100 nodos por década (~2.3% entre nodos)
+    const G4double kGridEmin = 1.*keV;
+    const G4double kNodesPerDecade = 100.;
+}
+
+// 1. CONSTRUCTOR
+// Se crea en cada hilo (ConstructSDandField); los comandos se reenvían
+SampleFastModel::SampleFastModel(const G4String& name, G4Region* envelope)
+: G4VFastSimulationModel(name, envelope),
+  fMessenger(nullptr),
+  fTransportScattered(true),
+  fInterpolated{0., 0., 0.}
+{
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/fast/", "Transporte rápido en la muestra");
+    fMessenger->DeclareProperty("transportScattered", fTransportScattered,
+                                "Seguir los fotones dispersados (false = solo los no colisionados)");
+}
+
+// 2. DESTRUCTOR
+SampleFastModel::~SampleFastModel()
+{
+    delete fMessenger;
+}
+
+// 3. CONDICIONES DE ACTIVACIÓN
+G4bool SampleFastModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+    return &particle == G4Gamma::Definition();
+}
+
+// Solo al entrar a la muestra. Los fotones dispersados nacen adentro y
+// siguen con el transporte completo.
+G4bool SampleFastModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+    if (fastTrack.OnTheBoundaryButExiting()) return false;
+    return fastTrack.GetEnvelopeSolid()->Inside(fastTrack.GetPrimaryTrackLocalPosition()) == kSurface;
+}
+
+// 4. SECCIONES EFICACES (nombres de procesos de G4EmStandardPhysics_option4)
+const SampleFastModel::CrossSections& SampleFastModel::GetNode(const G4Material* material, G4int node)
+{
+    auto key = std::make_pair(material, node);
+    auto it = fCache.find(key);
+    if (it != fCache.end()) return it->second;
+
+    G4double energy = kGridEmin * std::pow(10., node / kNodesPerDecade);
+    G4EmCalculator calculator;
+    const G4ParticleDefinition* gamma = G4Gamma::Definition();
+    CrossSections xs;
+    xs.compton = calculator.ComputeCrossSectionPerVolume(energy, gamma, "compt", material);
+    xs.rayleigh = calculator.ComputeCrossSectionPerVolume(energy, gamma, "Rayl", material);
+    xs.total = xs.compton + xs.rayleigh
+             + calculator.ComputeCrossSectionPerVolume(energy, gamma, "phot", material)
+             + calculator.ComputeCrossSectionPerVolume(energy, gamma, "conv", material);
+    return fCache.emplace(key, xs).first->second;
+}
+
+// Interpolación lineal en log(E) entre los dos nodos vecinos. Los bordes
+// de absorción de la muestra quedan suavizados en un intervalo de la grilla.
+const SampleFastModel::CrossSections& SampleFastModel::GetCrossSections(const G4Material* material,
+                                                                        G4double energy)
+{
+    G4double x = kNodesPerDecade * std::log10(std::max(energy, kGridEmin) / kGridEmin);
+    G4int node = G4int(x);
+    G4double f = x - node;
+
+    const CrossSections& a = GetNode(material, node);
+    const CrossSections& b = GetNode(material, node + 1);
+    fInterpolated.compton = a.compton + f * (b.compton - a.compton);
+    fInterpolated.rayleigh = a.rayleigh + f * (b.rayleigh - a.rayleigh);
+    fInterpolated.total = a.total + f * (b.total - a.total);
+    return fInterpolated;
+}
+
+// 5. MUESTREO DE LA DISPERSIÓN
+// Klein-Nishina para electrón libre (mismo método que G4KleinNishinaCompton,
+// sin ensanchamiento Doppler). Devuelve la energía del fotón dispersado.
+G4double SampleFastModel::SampleKleinNishina(G4double energy, G4double& cosTheta) const
+{
+    G4double k = energy / electron_mass_c2;
+    G4double eps0 = 1. / (1. + 2.*k);
+    G4double eps0sq = eps0 * eps0;
+    G4double alpha1 = -std::log(eps0);
+    G4double alpha2 = alpha1 + 0.5 * (1. - eps0sq);
+
+    G4double eps, epssq, oneMinusCos, reject;
+    do {
+        if (alpha1 > alpha2 * G4UniformRand()) {
+            eps = std::exp(-alpha1 * G4UniformRand());
+            epssq = eps * eps;
+        } else {
+            epssq = eps0sq + (1. - eps0sq) * G4UniformRand();
+            eps = std::sqrt(epssq);
+        }
+        oneMinusCos = (1. - eps) / (eps * k);
+        G4double sin2 = oneMinusCos * (2. - oneMinusCos);
+        reject = 1. - eps * sin2 / (1. + epssq);
+    } while (reject < G4UniformRand());
+
+    cosTheta = 1. - oneMinusCos;
+    return eps * energy;
+}
+
+// Rayleigh con la distribución de Thomson (1 + cos^2), sin factor de forma
+G4double SampleFastModel::SampleThomson() const
+{
+    G4double cosTheta;
+    do {
+        cosTheta = 2. * G4UniformRand() - 1.;
+    } while (2. * G4UniformRand() > 1. + cosTheta * cosTheta);
+    return cosTheta;
+}
+
+// 6. TRANSPORTE
+void SampleFastModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    G4ThreeVector position = fastTrack.GetPrimaryTrackLocalPosition();
+    G4ThreeVector direction = fastTrack.GetPrimaryTrackLocalDirection();
+    G4double energy = track->GetKineticEnergy();
+
+    G4double thickness = fastTrack.GetEnvelopeSolid()->DistanceToOut(position, direction);
+    const CrossSections& xs = GetCrossSections(fastTrack.GetEnvelopeMaterial(), energy);
+    G4double depth = (xs.total > 0.) ? -std::log(G4UniformRand()) / xs.total : DBL_MAX;
+
+    // Sin colisión: directo a la cara de salida
+    if (depth >= thickness) {
+        fastStep.ProposePrimaryTrackFinalPosition(position + thickness * direction);
+        fastStep.ProposePrimaryTrackPathLength(thickness);
+        fastStep.ProposePrimaryTrackFinalTime(track->GetGlobalTime() + thickness / c_light);
+        return;
+    }
+
+    // Con colisión: el primario termina en el punto de interacción
+    fastStep.ProposePrimaryTrackFinalPosition(position + depth * direction);
+    fastStep.ProposePrimaryTrackPathLength(depth);
+    fastStep.KillPrimaryTrack();
+
+    G4double process = G4UniformRand() * xs.total;
+    if (!fTransportScattered || process >= xs.compton + xs.rayleigh) {
+        fastStep.ProposeTotalEnergyDeposited(energy); // Fotoeléctrico o pares
+        return;
+    }
+
+    G4double cosTheta;
+    G4double scatteredEnergy = energy;
+    if (process < xs.compton) {
+        scatteredEnergy = SampleKleinNishina(energy, cosTheta);
+    } else {
+        cosTheta = SampleThomson();
+    }
+    G4double sinTheta = std::sqrt((1. - cosTheta) * (1. + cosTheta));
+    G4double phi = twopi * G4UniformRand();
+    G4ThreeVector newDirection(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+    newDirection.rotateUz(direction);
+
+    fastStep.ProposeTotalEnergyDeposited(energy - scatteredEnergy);
+    fastStep.SetNumberOfSecondaryTracks(1);
+    G4DynamicParticle photon(G4Gamma::Definition(), newDirection, scatteredEnergy);
+    fastStep.CreateSecondaryTrack(photon, position + depth * direction,
+                                  track->GetGlobalTime() + depth / c_light, true);
+}
@@ -18,7 +18,8 @@
  *   Barrido FINO: Eu152_REE_0p00.root, ..., Eu152_REE_0p01.root
  *   Barrido GRUESO: Eu152_REE_0p02.root, ..., Eu152_REE_0p05.root
  * 
- * Estructura: TTree "Scoring", Branch "Energy" en MeV
+ * Estructura: histograma H1 "Energy" en keV (salida por defecto), o bien
+ *             TTree "Scoring", Branch "Energy" en MeV (+ "Weight" opcional)
  * 
  * Uso: root -l 'AnalisisEu152_v6.cpp("./")'
  *      root -l 'AnalisisEu152_v6.cpp("./", true)'  // usa 1408 keV
@@ -315,6 +316,44 @@ void VisualizarSeparacionFondo(TH1D* h, double E_low, double E_high,
     delete spectrum;
 }
 
+// ============================================================================
+// FUNCIÓN: Leer el espectro de un archivo de la simulación
+// ============================================================================
+// Con /MedidorTR/output/histo (por defecto) el archivo ya trae el H1
+// "Energy" (keV) fusionado de todos los hilos. Con /MedidorTR/output/ntuple
+// se arma desde el TTree "Scoring", evento por evento como antes.
+// N_eventos = eventos con energía depositada, en ambos casos.
+
+TH1D* LeerEspectro(TFile* f, const char* nombre, Long64_t& N_eventos) {
+    TH1D* h_archivo = (TH1D*)f->Get("Energy");
+    if (h_archivo && h_archivo->GetEntries() > 0) {
+        TH1D* h = (TH1D*)h_archivo->Clone(nombre);
+        h->SetDirectory(0);  // Desvincular del directorio global
+        N_eventos = (Long64_t)h->GetEntries();
+        return h;
+    }
+
+    TTree* t = (TTree*)f->Get("Scoring");
+    if (!t) return nullptr;
+
+    N_eventos = t->GetEntries();
+    TH1D* h = new TH1D(nombre, "", 1600, 0, 1600);
+    h->SetDirectory(0);  // Desvincular del directorio global
+    h->Sumw2();
+
+    // Fuente sesgada (/MedidorTR/source/bias): cada evento lleva su peso.
+    // Archivos sin la rama "Weight" se llenan con peso 1 como antes.
+    Double_t energy;
+    Double_t weight = 1.0;
+    t->SetBranchAddress("Energy", &energy);
+    if (t->GetBranch("Weight")) t->SetBranchAddress("Weight", &weight);
+    for (Long64_t i = 0; i < N_eventos; i++) {
+        t->GetEntry(i);
+        h->Fill(energy * 1000.0, weight);  // MeV -> keV
+    }
+    return h;
+}
+
 // ============================================================================
 // FUNCIÓN PRINCIPAL
 // ============================================================================
@@ -352,24 +391,15 @@ void AnalisisEu152_v6(const char* directorio = "./", bool usar_1408 = false) {
         return;
     }
     
-    TTree* t_ref = (TTree*)f_ref->Get("Scoring");
-    if (!t_ref) {
-        std::cerr << "[ERROR] No se encontró TTree 'Scoring' en referencia" << std::endl;
+    // Histograma de referencia
+    Long64_t N_eventos_ref = 0;
+    TH1D* h_ref = LeerEspectro(f_ref, "h_ref", N_eventos_ref);
+    if (!h_ref) {
+        std::cerr << "[ERROR] No se encontró H1 'Energy' ni TTree 'Scoring' en referencia" << std::endl;
         f_ref->Close();
         return;
     }
-    
-    Long64_t N_eventos_ref = t_ref->GetEntries();
-    
-    // Crear histograma para referencia
-    TH1D* h_ref = new TH1D("h_ref", "Espectro Referencia", 1600, 0, 1600);
-    h_ref->SetDirectory(0);  // Desvincular del directorio global
-    Double_t energy;
-    t_ref->SetBranchAddress("Energy", &energy);
-    for (Long64_t i = 0; i < N_eventos_ref; i++) {
-        t_ref->GetEntry(i);
-        h_ref->Fill(energy * 1000.0);  // MeV -> keV
-    }
+    h_ref->SetTitle("Espectro Referencia");
     
     // Visualizar separación de fondo en referencia
     printf("[INFO] Visualizando separacion de fondo en referencia...\n");
@@ -431,27 +461,18 @@ void AnalisisEu152_v6(const char* directorio = "./", bool usar_1408 = false) {
             continue;
         }
         
-        TTree* t = (TTree*)f->Get("Scoring");
-        if (!t) {
-            std::cerr << "[WARN] No se encontró TTree en: " << filename << std::endl;
+        // Crear histograma
+        Long64_t N_eventos = 0;
+        TH1D* h = LeerEspectro(f, Form("h_%zu", i), N_eventos);
+        if (!h) {
+            std::cerr << "[WARN] No se encontró H1 'Energy' ni TTree en: " << filename << std::endl;
             f->Close();
             continue;
         }
         
-        Long64_t N_eventos = t->GetEntries();
-        
         // Factor de normalización
         double factor_norm = (double)N_eventos_ref / (double)N_eventos;
         
-        // Crear histograma
-        TH1D* h = new TH1D(Form("h_%zu", i), "", 1600, 0, 1600);
-        h->SetDirectory(0);  // Desvincular del directorio global
-        t->SetBranchAddress("Energy", &energy);
-        for (Long64_t j = 0; j < N_eventos; j++) {
-            t->GetEntry(j);
-            h->Fill(energy * 1000.0);
-        }
-        
         // Analizar picos con TSpectrum
         ResultadoTSpectrum pico_low = AnalizarPicoTSpectrum(h, E_LOW, tolerancia_low, factor_norm, false);
         ResultadoTSpectrum pico_high = AnalizarPicoTSpectrum(h, E_HIGH, tolerancia_high, factor_norm, false);
@@ -0,0 +1,282 @@
+/**
+ * @file ReweightEu152.cpp
+ * @brief Repesado de un único run de referencia a cualquier concentración REE
+ *
+ * ARCHIVOS ESPERADOS (un solo run con /MedidorTR/reweight/record true):
+ *   Eu152_REE_ref.root     TTree "Scoring": Energy, Weight, PathE, PathL, PathProc
+ *   Eu152_REE_ref_xs.csv   Coeficientes másicos por proceso (matriz y REE puro)
+ *
+ * MÉTODO:
+ *   Para cada evento y concentración c, el peso es el cociente de
+ *   verosimilitudes del transporte de los fotones en la muestra:
+ *     W(c) = prod_pasos exp(-(mu(E,c) - mu(E,c0)) l)
+ *          * prod_interacciones mu_p(E,c) / mu_p(E,c0)
+ *   con mu_p(E,c) = rho(c) [(1-c) m_p,matriz(E) + c m_p,REE(E)].
+ *   Los espectros repesados se integran igual que en AnalisisEu152_v4
+ *   (pico +/- ventana menos bandas laterales).
+ *
+ *   El error crece cuanto más lejos está c de c0: conviene una referencia
+ *   en el medio del rango. La columna ESS (tamaño efectivo de la muestra,
+ *   relativo a los eventos del run) indica cuándo dejar de confiar.
+ *
+ * APROXIMACIONES (ver SamplePathSD.hh):
+ *   Solo cambian con c los coeficientes de atenuación. Quedan como en c0:
+ *   las distribuciones angulares de Rayleigh y Compton de la mezcla, la
+ *   fluorescencia tras el fotoeléctrico (rayos X K del Ce, ~35-40 keV) y
+ *   los electrones que salen de la muestra. Válido para el barrido fino
+ *   (REE <= ~1% en masa); para 2-5% usar runs directos o validar contra
+ *   uno. Avisa si alguna concentración (o c0) pasa de C_MAX_VALIDA.
+ *
+ * Uso: root -l 'ReweightEu152.cpp("Eu152_REE_ref.root", "0,0.002,0.004,0.006,0.008,0.01")'
+ *      root -l 'ReweightEu152.cpp("Eu152_REE_ref.root", "0,0.01,0.02", "Scoring_1")'  // multi-línea
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TH1D.h"
+#include "TString.h"
+
+// Concentración máxima (fracción másica) en la que se validan las
+// aproximaciones del repesado
+const double C_MAX_VALIDA = 0.01;
+
+// ============================================================================
+// TABLA DE SECCIONES EFICACES (<archivo>_xs.csv)
+// ============================================================================
+
+// Subtipos EM de Geant4 guardados en PathProc (0 = sin interacción)
+const int PROC_RAYL  = 11;
+const int PROC_PHOT  = 12;
+const int PROC_COMPT = 13;
+const int PROC_CONV  = 14;
+
+struct TablaXS {
+    double rho0, rho1;                 // g/cm3 a c = 0 y c = 1
+    std::vector<double> lnE;           // ln(E/MeV)
+    std::vector<double> base[4];       // cm2/g: Rayl, phot, compt, conv
+    std::vector<double> ree[4];
+    std::vector<double> ref;           // Concentración de referencia por línea
+
+    bool Leer(const std::string& archivo) {
+        std::ifstream f(archivo);
+        if (!f) return false;
+        std::string linea;
+        while (std::getline(f, linea)) {
+            if (linea.empty()) continue;
+            std::replace(linea.begin(), linea.end(), ',', ' ');
+            std::istringstream in(linea);
+            if (linea[0] == '#') {
+                std::string hash, clave;
+                in >> hash >> clave;
+                if (clave == "rho0_g_cm3") in >> rho0;
+                else if (clave == "rho1_g_cm3") in >> rho1;
+                else if (clave == "ref") { int copia; double c; in >> copia >> c; ref.push_back(c); }
+                continue;
+            }
+            double E;
+            if (!(in >> E)) continue;      // Encabezado de columnas
+            lnE.push_back(std::log(E));
+            for (int p = 0; p < 4; p++) { double v; in >> v; base[p].push_back(v); }
+            for (int p = 0; p < 4; p++) { double v; in >> v; ree[p].push_back(v); }
+        }
+        return lnE.size() > 1 && !ref.empty();
+    }
+
+    // Interpolación lineal en ln E del coeficiente lineal (1/cm) del proceso p
+    double Mu(int p, double E, double c) const {
+        double x = std::log(E);
+        std::size_t i = std::upper_bound(lnE.begin(), lnE.end(), x) - lnE.begin();
+        if (i == 0) i = 1;
+        if (i >= lnE.size()) i = lnE.size() - 1;
+        double t = (x - lnE[i-1]) / (lnE[i] - lnE[i-1]);
+        double mb = base[p][i-1] + t * (base[p][i] - base[p][i-1]);
+        double mr = ree[p][i-1] + t * (ree[p][i] - ree[p][i-1]);
+        double rho = rho0 * (1. - c) + rho1 * c;
+        return std::max(0., rho * ((1. - c) * mb + c * mr));
+    }
+
+    double MuTotal(double E, double c) const {
+        return Mu(0, E, c) + Mu(1, E, c) + Mu(2, E, c) + Mu(3, E, c);
+    }
+};
+
+int IndiceProceso(int proc) {
+    if (proc == PROC_RAYL)  return 0;
+    if (proc == PROC_PHOT)  return 1;
+    if (proc == PROC_COMPT) return 2;
+    if (proc == PROC_CONV)  return 3;
+    return -1;
+}
+
+// ============================================================================
+// FUNCIÓN: Integrar fotopico con sustracción de fondo (histograma pesado)
+// ============================================================================
+
+struct PicoPesado {
+    double netas;
+    double error;
+};
+
+PicoPesado IntegrarPesado(TH1D* h, double E, double w) {
+    PicoPesado p;
+    double ePico, eIzq, eDer;
+    double pico = h->IntegralAndError(h->FindBin(E - w), h->FindBin(E + w) - 1, ePico);
+    double izq  = h->IntegralAndError(h->FindBin(E - 2*w), h->FindBin(E - w) - 1, eIzq);
+    double der  = h->IntegralAndError(h->FindBin(E + w), h->FindBin(E + 2*w) - 1, eDer);
+    // Las dos bandas suman el mismo ancho que el pico
+    p.netas = pico - (izq + der);
+    p.error = std::sqrt(ePico*ePico + eIzq*eIzq + eDer*eDer);
+    return p;
+}
+
+// ============================================================================
+// FUNCIÓN PRINCIPAL
+// ============================================================================
+
+void ReweightEu152(const char* archivo_ref = "Eu152_REE_ref.root",
+                   const char* concentraciones = "0,0.002,0.004,0.006,0.008,0.01",
+                   const char* arbol = "Scoring",
+                   const char* salida = "Reweight_resultados.csv",
+                   double E_LOW = 121.78, double E_HIGH = 344.28,
+                   double ventana_low = 12.0, double ventana_high = 20.0) {
+
+    // Concentraciones objetivo (fracción másica)
+    std::vector<double> conc;
+    {
+        std::string lista(concentraciones);
+        std::replace(lista.begin(), lista.end(), ',', ' ');
+        std::istringstream in(lista);
+        double c;
+        while (in >> c) conc.push_back(c);
+    }
+    if (conc.empty()) {
+        std::cerr << "[ERROR] Lista de concentraciones vacía" << std::endl;
+        return;
+    }
+
+    // Tabla de secciones eficaces junto al .root
+    TString archivo_xs(archivo_ref);
+    archivo_xs.ReplaceAll(".root", "");
+    archivo_xs += "_xs.csv";
+    TablaXS xs;
+    if (!xs.Leer(archivo_xs.Data())) {
+        std::cerr << "[ERROR] No se puede leer la tabla: " << archivo_xs << std::endl;
+        return;
+    }
+
+    TFile* f = TFile::Open(archivo_ref);
+    if (!f || f->IsZombie()) {
+        std::cerr << "[ERROR] No se puede abrir: " << archivo_ref << std::endl;
+        return;
+    }
+    TTree* t = (TTree*)f->Get(arbol);
+    if (!t || !t->GetBranch("PathE")) {
+        std::cerr << "[ERROR] TTree '" << arbol << "' sin columnas PathE/PathL/PathProc" << std::endl;
+        return;
+    }
+
+    // Concentración de referencia de la línea (Scoring_<copia>)
+    int copia = 0;
+    TString nombre(arbol);
+    if (nombre.BeginsWith("Scoring_")) copia = TString(nombre(8, nombre.Length())).Atoi();
+    double c0 = xs.ref[std::min<std::size_t>(copia, xs.ref.size() - 1)];
+    double c_max = std::max(c0, *std::max_element(conc.begin(), conc.end()));
+    if (c_max > C_MAX_VALIDA) {
+        std::cerr << "[WARN] REE = " << c_max << " > " << C_MAX_VALIDA
+                  << ": el repesado ignora el cambio de las distribuciones angulares"
+                  << " y de la fluorescencia; validar contra un run directo" << std::endl;
+    }
+
+    double energia = 0., peso = 1.;
+    std::vector<double>* pathE = nullptr;
+    std::vector<double>* pathL = nullptr;
+    std::vector<int>* pathProc = nullptr;
+    t->SetBranchAddress("Energy", &energia);
+    t->SetBranchAddress("Weight", &peso);
+    t->SetBranchAddress("PathE", &pathE);
+    t->SetBranchAddress("PathL", &pathL);
+    t->SetBranchAddress("PathProc", &pathProc);
+
+    std::cout << "\n" << std::string(80, '=') << std::endl;
+    std::cout << "  REPESADO Eu-152 - referencia REE = " << c0 << " (" << arbol << ")" << std::endl;
+    std::cout << "  Eventos: " << t->GetEntries() << " | Concentraciones: " << conc.size() << std::endl;
+    std::cout << std::string(80, '=') << std::endl;
+
+    std::vector<TH1D*> h(conc.size());
+    std::vector<double> sumW(conc.size(), 0.), sumW2(conc.size(), 0.);
+    for (std::size_t k = 0; k < conc.size(); k++) {
+        h[k] = new TH1D(Form("h_rw_%zu", k), Form("REE = %g", conc[k]), 1600, 0, 1600);
+        h[k]->Sumw2();
+    }
+
+    // =========================================================================
+    // Un solo recorrido del árbol: todas las concentraciones a la vez
+    // =========================================================================
+    std::vector<double> lnW(conc.size());
+    Long64_t nEntries = t->GetEntries();
+    for (Long64_t i = 0; i < nEntries; i++) {
+        t->GetEntry(i);
+        std::fill(lnW.begin(), lnW.end(), 0.);
+
+        for (std::size_t s = 0; s < pathE->size(); s++) {
+            double E = (*pathE)[s];
+            double l = (*pathL)[s] / 10.;            // mm -> cm
+            int p = IndiceProceso((*pathProc)[s]);
+            double mu0 = xs.MuTotal(E, c0);
+            double mu0p = (p >= 0) ? xs.Mu(p, E, c0) : 0.;
+            for (std::size_t k = 0; k < conc.size(); k++) {
+                lnW[k] -= (xs.MuTotal(E, conc[k]) - mu0) * l;
+                if (p >= 0 && mu0p > 0.) lnW[k] += std::log(xs.Mu(p, E, conc[k]) / mu0p);
+            }
+        }
+
+        for (std::size_t k = 0; k < conc.size(); k++) {
+            double w = peso * std::exp(lnW[k]);
+            h[k]->Fill(energia * 1000., w);
+            sumW[k] += w;
+            sumW2[k] += w * w;
+        }
+    }
+
+    // =========================================================================
+    // Índice Q = N_low / N_high por concentración
+    // =========================================================================
+    std::ofstream out(salida);
+    out << "REE,N_low,errN_low,N_high,errN_high,Q,errQ,Q_rel,errQ_rel,ESS\n";
+    double Q0 = 0., errQ0 = 0.;
+    printf("\n   REE      N_low          N_high         Q/Q0            ESS\n");
+    for (std::size_t k = 0; k < conc.size(); k++) {
+        PicoPesado low = IntegrarPesado(h[k], E_LOW, ventana_low);
+        PicoPesado high = IntegrarPesado(h[k], E_HIGH, ventana_high);
+        double Q = (high.netas > 0.) ? low.netas / high.netas : 0.;
+        double errQ = (low.netas > 0. && high.netas > 0.)
+            ? Q * std::sqrt(std::pow(low.error / low.netas, 2) + std::pow(high.error / high.netas, 2)) : 0.;
+        if (k == 0) { Q0 = Q; errQ0 = errQ; }   // Normalización: primer punto de la lista
+        double Qrel = (Q0 > 0.) ? Q / Q0 : 0.;
+        double errQrel = (Q0 > 0. && Q > 0.)
+            ? Qrel * std::sqrt(std::pow(errQ / Q, 2) + (k ? std::pow(errQ0 / Q0, 2) : 0.)) : 0.;
+        double ess = (sumW2[k] > 0.) ? sumW[k] * sumW[k] / sumW2[k] / nEntries : 0.;
+
+        out << conc[k] << "," << low.netas << "," << low.error << "," << high.netas << ","
+            << high.error << "," << Q << "," << errQ << "," << Qrel << "," << errQrel << "," << ess << "\n";
+        printf("  %6.4f  %8.0f +/- %-5.0f %8.0f +/- %-5.0f %.5f +/- %.5f  %.3f\n",
+               conc[k], low.netas, low.error, high.netas, high.error, Qrel, errQrel, ess);
+    }
+    std::cout << "\n[INFO] Resultados -> " << salida << std::endl;
+
+    // Espectros repesados para comparar con los runs directos
+    TString archivo_h(salida);
+    archivo_h.ReplaceAll(".csv", ".root");
+    TFile fout(archivo_h, "RECREATE");
+    for (TH1D* hk : h) hk->Write();
+    fout.Close();
+    std::cout << "[INFO] Espectros -> " << archivo_h << std::endl;
+}
@@ -0,0 +1,51 @@
+#!/bin/bash
+# =============================================================
+# escalado_hilos.sh - Eventos/s en función del número de hilos
+# =============================================================
+# Uso: ./escalado_hilos.sh [N_max] [opciones del ejecutable...]
+#   N_max: máximo de hilos (por defecto, los núcleos del nodo)
+#   Ej.:   ./escalado_hilos.sh 64 --run-manager tasking --seed-once-per-batch
+# Corre escalado_Eu152.mac con 1, 2, 4, ... N_max hilos y escribe
+# escalado_hilos.csv con eventos/s, speedup y eficiencia respecto de 1 hilo.
+
+EXEC="./Simulacion_Europio"
+MACRO="escalado_Eu152.mac"
+OUTPUT="escalado_hilos.csv"
+if [ ! -f "$EXEC" ]; then
+    echo "ERROR: No se encuentra $EXEC"
+    echo "¿Ejecutaste cmake y make?"
+    exit 1
+fi
+
+NMAX=${1:-$(nproc)}
+[ $# -gt 0 ] && shift
+OPTIONS="$@"
+
+# 1, 2, 4, ... y N_max al final si no es potencia de 2
+HILOS=()
+for ((t = 1; t < NMAX; t *= 2)); do HILOS+=($t); done
+HILOS+=($NMAX)
+
+echo "=== ESCALADO CON LOS HILOS (hasta $NMAX) ==="
+echo "Opciones: ${OPTIONS:-(ninguna)}"
+echo "hilos,eventos_s,speedup,eficiencia" > "$OUTPUT"
+
+BASE=""
+for t in "${HILOS[@]}"; do
+    # Solo cuenta el último run de la macro (el primero es de calentamiento)
+    RATE=$($EXEC --threads $t $OPTIONS $MACRO 2>&1 \
+           | grep ">>> \[Master\] Run" | tail -1 | sed -E 's/.*\(([0-9.eE+-]+) eventos\/s\).*/\1/')
+    if [ -z "$RATE" ]; then
+        echo "ERROR: sin resultado con $t hilos"
+        exit 1
+    fi
+    [ -z "$BASE" ] && BASE=$RATE
+
+    # awk y no bc: G4cout puede escribir la tasa como 1.23457e+06
+    LINEA=$(awk -v t=$t -v r=$RATE -v b=$BASE 'BEGIN { s = r / b; printf "%d,%.1f,%.3f,%.3f", t, r, s, s / t }')
+    echo "$LINEA" >> "$OUTPUT"
+    echo "$LINEA" | awk -F, '{ printf "    %3d hilos: %12.1f eventos/s | speedup %6.2f | eficiencia %5.1f%%\n", $1, $2, $3, $4 * 100 }'
+done
+
+rm -f Eu152_escalado.root Eu152_escalado_ROI.csv
+echo "=== Resultado en $OUTPUT ==="
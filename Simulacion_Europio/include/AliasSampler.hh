@@ -0,0 +1,25 @@
+#ifndef AliasSampler_h
+#define AliasSampler_h 1
+
+#include "globals.hh"
+#include <vector>
+
+// Muestreo de una distribución discreta en tiempo constante (método alias
+// de Walker, construcción de Vose). Se construye una vez con los pesos
+// (no hace falta normalizarlos) y cada muestra cuesta un número aleatorio.
+class AliasSampler
+{
+  public:
+    AliasSampler();
+    ~AliasSampler();
+
+    void        Build(const std::vector<G4double>& weights);
+    std::size_t Sample() const;
+    std::size_t GetSize() const { return fProbability.size(); }
+
+  private:
+    std::vector<G4double>    fProbability; // Probabilidad de quedarse en la celda
+    std::vector<std::size_t> fAlias;       // Índice alternativo de la celda
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef CascadeTable_h
+#define CascadeTable_h 1
+
+#include "AliasSampler.hh"
+#include "globals.hh"
+#include <vector>
+
+// Tabla de cascadas gamma/X del Eu-152 por decaimiento.
+// Cada entrada es un patrón (lista de energías de fotones emitidos en un
+// mismo decaimiento) con su frecuencia. Muestrear un patrón conserva las
+// multiplicidades y coincidencias de la cascada sin crear el ion.
+//
+// La tabla se genera una vez desde los datos de G4RadioactiveDecay
+// (/MedidorTR/table/record, ver genera_tabla_Eu152.mac): durante el run
+// siguiente, con la fuente ion, se registran los fotones creados por el
+// decaimiento en cada evento, hasta los decaimientos pedidos (el run se
+// detiene ahí). Cada hilo acumula su propia tabla, que se suma al final
+// del run; en modo multi-línea hay una tabla por línea
+// (<archivo>_<copia>.<ext>).
+//
+// Formato del archivo (una línea por patrón):
+//   <cuentas> <E1 [keV]> <E2 [keV]> ...
+// Las líneas que empiezan con '#' son comentarios. Un patrón sin
+// energías (decaimiento sin fotones) también cuenta para la normalización.
+class CascadeTable
+{
+  public:
+    CascadeTable();
+    ~CascadeTable();
+
+    G4bool Load(const G4String& fileName);
+    G4bool IsLoaded() const { return !fPatterns.empty(); }
+    std::size_t GetNumberOfPatterns() const { return fPatterns.size(); }
+
+    // Energías del patrón sorteado (unidades internas de Geant4)
+    const std::vector<G4double>& Sample() const { return fPatterns[fSampler.Sample()]; }
+
+    // --- Modo de líneas ---
+    // Un fotón por evento: con probabilidad (1 - continuumFraction) una de
+    // las líneas seleccionadas (proporcional a su intensidad) y si no una
+    // del resto. El peso devuelto por SampleLine es intensidad/probabilidad,
+    // así el espectro por decaimiento de las líneas emitidas no cambia.
+    // Se pierden las coincidencias de la cascada (suma de picos).
+    G4bool   SelectLines(const std::vector<G4double>& energies,
+                         G4double continuumFraction, G4double tolerance);
+    G4double SampleLine(G4double& energy) const;
+    G4double GetLineIntensity(G4double energy, G4double tolerance) const;
+
+    // --- Registro (compartido por todos los hilos) ---
+    // decays = decaimientos por línea a registrar (0 = todo el run)
+    static void   StartRecording(const G4String& fileName, G4long decays);
+    static void   BeginOfRun(G4int nLines);           // Master
+    static G4bool IsRecording();
+    static void   Record(const std::vector<std::vector<G4double>>& cascades); // Una por línea
+    static void   FlushThread();                      // Cada hilo, al final del run
+    static void   WriteRecording();                   // Master, después de los workers
+
+  private:
+    std::vector<std::vector<G4double>> fPatterns;
+    AliasSampler fSampler;
+
+    std::vector<G4double> fLineEnergies;    // Líneas individuales de la tabla
+    std::vector<G4double> fLineIntensities; // Fotones por decaimiento
+
+    std::vector<G4double> fEmitEnergies;    // Líneas que emite el modo de líneas
+    std::vector<G4double> fEmitWeights;     // Peso de cada una
+    AliasSampler fLineSampler;
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 #include "G4VUserDetectorConstruction.hh"
 #include "globals.hh"
+#include "G4ThreeVector.hh"
+#include <vector>
 
 // --- SECCIÓN DE DECLARACIONES ANTICIPADAS (AQUÍ ESTABA EL ERROR 1) ---
 // Esto arregla el error "G4Material does not name a type"
@@ -18,25 +20,97 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     virtual ~DetectorConstruction();
 
     virtual G4VPhysicalVolume* Construct();
+    virtual void ConstructSDandField(); // Scorer "Detector/eDep" en el cristal
     
     // --- NUEVA FUNCIÓN (AQUÍ ESTABA EL ERROR 2) ---
     // Debes declarar la función aquí para que el .cc sepa que pertenece a la clase
     void SetREEConcentration(G4double fraction);
-    // NUEVO: Función para que el SteppingAction sepa cuál es el detector
+
+    // Conjunto de concentraciones declarado de antemano (barridos).
+    // Si la concentración pedida está en el conjunto, SetREEConcentration
+    // solo cambia el material de las muestras que siguen a setREE (sin
+    // reabrir la geometría).
+    void AddREEToSet(G4double fraction);
+    void PrepareREESet();
+    // Volumen del detector (lleva el detector sensible)
     G4LogicalVolume* GetScoringVolume() const { return fLogicDetector; }
 
+    // Multi-línea: N copias aisladas de fuente/muestra/detector.
+    // La copia i del detector tiene número de copia i.
+    void     SetBeamlineREE(G4int copy, G4double fraction);
+    G4int    GetNumberOfBeamlines() const { return fNumBeamlines; }
+    G4double GetBeamlineOffset(G4int copy) const; // Posición X del eje de la línea
+    G4double GetBeamlineREE(G4int copy) const;
+    G4Material* GetBeamlineMaterial(G4int copy) const; // Material de la muestra de la línea
+    G4int    GetBeamlineAt(G4double x) const;     // Línea que contiene la coordenada X
+
+    // Cota inferior de la distancia de un punto al detector más cercano
+    // (esfera que envuelve el cristal). La usa el StackingAction.
+    G4double GetDistanceToDetector(const G4ThreeVector& point) const;
+    G4double GetDetectorZ() const { return fDetectorZ; }
+    G4double GetDetectorBoundingRadius() const { return fDetectorBoundingRadius; }
+
+    // Regiones (/MedidorTR/regions/): Mundo (región por defecto), Sample y
+    // Detector, cada una con su corte de producción y energía mínima.
+    // El corte del mundo es el corte por defecto que aplica el PhysicsList.
+    G4double GetWorldCut() const { return fCutWorld; }
+
+    // Material de la muestra para una concentración (se crea una sola vez)
+    // y espesor de la muestra: los usa el TransmissionCalculator
+    G4Material* BuildApatiteWithREE(G4double fraction);
+    G4double    GetSampleThickness() const { return fSampleThickness; }
+    G4double    GetSampleDensity(G4double fraction) const; // Lineal en la fracción másica
+
+    // Repesado (/MedidorTR/reweight/record): detector sensible "SamplePath"
+    // en las muestras y pasos de los fotones en la NTuple
+    G4bool IsPathRecording() const { return fRecordPaths; }
+
+    // Espacio de fases (/MedidorTR/phsp/): plano "PhaseSpacePlane" entre
+    // la muestra y el detector con el detector sensible "PhaseSpace"
+    G4bool   IsPhaseSpacePlane() const { return fPhaseSpacePlane; }
+    G4double GetPhaseSpaceZ() const    { return fPhaseSpaceZ; }
+    G4bool   IsKillAtPlane() const     { return fKillAtPlane; }
+
   private:
     void DefineMaterials();
+    void        UpdateSampleMaterials(); // Material de setREE en las líneas que lo siguen
+    void        ConstructRegions();
+    G4bool      IsInREESet(G4double fraction) const;
 
     // Volúmenes lógicos que queremos manipular
-    G4LogicalVolume* fLogicSample; 
+    G4LogicalVolume* fLogicSample;   // Muestra de la línea 0
+    std::vector<G4LogicalVolume*> fLogicSamples; // Una muestra por línea
 
     // --- NUEVAS VARIABLES (AQUÍ ESTABA EL ERROR 3) ---
     G4Material* fApatiteWithREE; // El material dinámico
     G4GenericMessenger* fMessenger;      // El comunicador con la macro
     G4double            fREEFraction;    // La variable de concentración
+    std::vector<G4double> fREESet;       // Concentraciones pre-construidas
+    std::size_t fREESetPrepared;         // Las primeras N ya tienen tablas
     // NUEVO: Variable para guardar el detector
     G4LogicalVolume* fLogicDetector;
+    G4LogicalVolume* fLogicPhaseSpace; // Plano del espacio de fases (si hay)
+
+    G4int    fNumBeamlines;      // Número de líneas replicadas
+    G4double fBeamlinePitch;     // Separación en X entre ejes
+    G4double fAbsorberThickness; // Espesor de la pared entre líneas
+    std::vector<G4double> fBeamlineREE; // Concentración por línea (<0: la de setREE)
+
+    G4double fSampleThickness;        // Espesor en Z de la muestra
+    G4double fDetectorZ;              // Posición Z del centro del cristal
+    G4double fDetectorBoundingRadius; // Radio de la esfera que lo envuelve
+
+    G4GenericMessenger* fRegionMessenger;
+    G4double fCutWorld, fCutSample, fCutDetector;    // Cortes de producción
+    G4double fEminWorld, fEminSample, fEminDetector; // G4UserLimits: energía mínima
+
+    G4GenericMessenger* fReweightMessenger;
+    G4bool fRecordPaths; // Registrar los pasos de los fotones en la muestra
+
+    G4GenericMessenger* fPhaseSpaceMessenger;
+    G4bool   fPhaseSpacePlane; // Construir el plano y escribir <archivo>.phsp
+    G4double fPhaseSpaceZ;     // Posición Z del plano
+    G4bool   fKillAtPlane;     // No seguir las partículas más allá del plano
 };
 
 #endif
\ No newline at end of file
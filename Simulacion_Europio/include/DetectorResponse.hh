@@ -0,0 +1,42 @@
+#ifndef DetectorResponse_h
+#define DetectorResponse_h 1
+
+#include "globals.hh"
+
+class G4GenericMessenger;
+
+// Respuesta del LaBr3(Ce) aplicada en el bucle de eventos
+// (/MedidorTR/response/...), en lugar del smearing en ROOT de NOTAS_Eu152.md.
+//   FWHM(E) = a + b*sqrt(E) + c*E   (E y FWHM en keV)
+// La energía "medida" se agrupa después en los canales del MCA y se usa
+// el centro del canal. El H1, la NTuple y las ROIs reciben esa energía.
+// Una instancia por hilo (vive en el RunAction): usa el motor aleatorio
+// del hilo.
+class DetectorResponse
+{
+  public:
+    DetectorResponse();
+    ~DetectorResponse();
+
+    // Energía medida; <= 0 si el evento queda fuera del MCA (no se guarda)
+    G4double Apply(G4double edep) const;
+
+    G4bool   IsEnabled() const { return fEnabled; }
+    G4double GetFWHM(G4double energy) const;
+
+    // Canales del MCA (0 = sin canalizar) y energía del último canal
+    G4int    GetChannels() const { return fEnabled ? fChannels : 0; }
+    G4double GetChannelEmax() const { return fChannelEmax; }
+
+  private:
+    G4GenericMessenger* fMessenger;
+
+    G4bool   fEnabled;
+    G4double fA;           // keV
+    G4double fB;           // keV^(1/2)
+    G4double fC;           // adimensional
+    G4int    fChannels;    // Canales del ADC
+    G4double fChannelEmax; // Energía del borde superior del último canal
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef DualEnergyIndex_h
+#define DualEnergyIndex_h 1
+
+#include "RoiCounter.hh"
+#include "globals.hh"
+
+class G4GenericMessenger;
+class DetectorConstruction;
+
+// Índice dual-energy calculado en línea (/MedidorTR/index/...).
+// Mismo método que AnalisisEu152_v4: cuentas netas de la línea baja
+// (121.78 keV) y alta (344.28 keV) en una ventana +/- w, con el fondo
+// estimado en las dos bandas laterales de ancho w. Q = N_low / N_high.
+//
+// Hay una instancia por hilo (los workers llenan su RoiCounter); la del
+// Master, al final de cada run, calcula Q, las transmisiones y el Z-score
+// contra la referencia 0% REE y agrega una fila al CSV de resultados.
+// La referencia es el primer run (o línea) con REE = 0 y cuentas netas en
+// ambas líneas; se guarda en un archivo para que otros procesos del mismo
+// barrido la usen. Apagado por defecto: lo encienden los barridos
+// (/MedidorTR/index/enable true).
+class DualEnergyIndex
+{
+  public:
+    DualEnergyIndex();
+    ~DualEnergyIndex();
+
+    void Fill(G4int copy, G4double edep, G4double weight);
+    // nEvents: eventos de todo el run (con checkpoint, de todos los segmentos)
+    void EndOfRun(G4long nEvents, const DetectorConstruction* detector, const G4String& fileName);
+
+    void SetLines(G4double eLowKeV, G4double eHighKeV);
+    void SetWindows(G4double wLowKeV, G4double wHighKeV);
+
+    // Contadores del hilo y error relativo de Q con una suma de ellos
+    // (lo usa el PrecisionMonitor durante el run)
+    G4bool IsEnabled() const { return fEnabled; }
+    const RoiCounter& GetCounter() const { return fCounter; }
+    G4bool RestoreCounter(std::istream& in) { return fCounter.Read(in); }
+    static G4double GetRelativeErrorQ(const RoiCounter& counter, G4int copy);
+
+  private:
+    struct Line { G4double net; G4double error; };
+    // line: 0 = baja, 1 = alta
+    static Line NetCounts(const RoiCounter& counter, G4int copy, G4int line);
+    void   UpdateROIs();
+    G4bool LoadReference();
+    void   SaveReference() const;
+
+    G4GenericMessenger* fMessenger;
+    RoiCounter fCounter;  // G4Accumulable: pico, banda izq., banda der. por línea
+
+    G4bool   fEnabled;
+    G4double fELow, fEHigh;  // Energías de las líneas
+    G4double fWLow, fWHigh;  // Semiancho de las ventanas
+    G4String fReferenceFile;
+    G4String fResultsFile;
+
+    // Referencia 0% REE, por evento simulado
+    G4bool   fHasReference;
+    G4double fRefLow, fRefLowErr;   // N_low / eventos
+    G4double fRefHigh, fRefHighErr; // N_high / eventos
+};
+
+#endif
@@ -3,21 +3,57 @@
 
 #include "G4UserEventAction.hh"
 #include "globals.hh" // <--- CORREGIDO
+#include <vector>
+
+class RunAction;
+class SamplePathSD;
+class PhaseSpaceWriter;
 
 class EventAction : public G4UserEventAction
 {
   public:
-    EventAction();
+    EventAction(RunAction* runAction);
     virtual ~EventAction();
 
     virtual void BeginOfEventAction(const G4Event*);
     virtual void EndOfEventAction(const G4Event*);
 
-    // Función para acumular energía (llamada por SteppingAction)
-    void AddEdep(G4double edep) { fEdep += edep; }
+    // Función para acumular energía (se llena desde el scorer del detector)
+    // copy = número de copia del detector (línea en modo multi-línea)
+    void AddEdep(G4double edep, G4int copy = 0) {
+        if (copy >= G4int(fEdep.size())) Resize(copy + 1);
+        fEdep[copy] += edep;
+    }
+
+    // Peso estadístico del evento (fuente sesgada). Es el producto de los
+    // pesos de cada fotón sesgado de esa línea. Lo llaman el generador
+    // (antes de BeginOfEventAction) y el StackingAction, por eso se
+    // reinicia al FINAL del evento y no al principio.
+    void MultiplyWeight(G4double weight, G4int copy = 0) {
+        if (copy >= G4int(fWeight.size())) Resize(copy + 1);
+        fWeight[copy] *= weight;
+    }
+
+    // Registro de la tabla de cascadas: fotones del decaimiento de este
+    // evento, por línea
+    void AddCascadeGamma(G4double energy, G4int copy = 0) {
+        if (copy >= G4int(fCascade.size())) fCascade.resize(copy + 1);
+        fCascade[copy].push_back(energy);
+    }
 
   private:
-    G4double fEdep; // Variable para sumar energía total del evento
+    void Resize(std::size_t n) {
+        fEdep.resize(n, 0.);
+        fWeight.resize(n, 1.);
+    }
+
+    RunAction* fRunAction;         // Tipo de salida y contadores de ROI
+    G4int fEdepHCID;               // Colección "Detector/eDep" (se busca una vez)
+    const SamplePathSD* fSamplePathSD; // Pasos en la muestra (solo con repesado)
+    PhaseSpaceWriter* fPhaseSpace;     // Plano del espacio de fases (si hay)
+    std::vector<G4double> fEdep;   // Energía total del evento, una por línea
+    std::vector<G4double> fWeight; // Peso del evento, uno por línea
+    std::vector<std::vector<G4double>> fCascade; // Energías de la cascada por línea (solo al registrar)
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,89 @@
+#ifndef PhaseSpace_h
+#define PhaseSpace_h 1
+
+#include "G4VSensitiveDetector.hh"
+#include "globals.hh"
+#include <vector>
+
+class DetectorConstruction;
+
+// Espacio de fases en el plano entre la muestra y el detector
+// (/MedidorTR/phsp/...). Desacopla el transporte fuente + muestra (caro)
+// de la respuesta del detector: se escribe una vez y se reproduce con
+// /MedidorTR/source/phaseSpace para estudiar otro cristal o distancia.
+//
+// Formato binario <archivo>.phsp: un encabezado PhaseSpaceHeader y luego
+// un PhaseSpaceRecord por partícula que cruza el plano hacia +Z. Las
+// partículas de un mismo evento van juntas (coincidencias de la cascada):
+// el primer registro de cada evento tiene newEvent = 1.
+struct PhaseSpaceHeader
+{
+    char    magic[4];      // "PHSP"
+    G4int   version;
+    G4long  sourceEvents;  // Eventos simulados (normalización)
+    G4long  records;
+    G4float planeZ;        // mm
+};
+
+struct PhaseSpaceRecord
+{
+    G4int   newEvent;      // 1 = primera partícula de un evento
+    G4int   line;          // Número de copia (multi-línea)
+    G4int   pdg;
+    G4float energy;        // MeV
+    G4float x, y, z;       // mm, X relativo al eje de la línea
+    G4float u, v, w;       // Dirección
+    G4float weight;        // Peso del evento en esa línea (fuente sesgada)
+};
+
+// Detector sensible del plano: arma los registros del evento y el
+// EventAction los cierra con FinishEvent (ahí se conoce el peso final).
+// Los hilos acumulan en un buffer propio y lo vuelcan bajo mutex al
+// archivo compartido, que abre y cierra el Master.
+class PhaseSpaceWriter : public G4VSensitiveDetector
+{
+  public:
+    PhaseSpaceWriter(const G4String& name, const DetectorConstruction* detector);
+    virtual ~PhaseSpaceWriter();
+
+    virtual void Initialize(G4HCofThisEvent*);
+    void FinishEvent(const std::vector<G4double>& weights);
+
+    static void Open(const G4String& fileName, G4double planeZ); // Master, inicio del run
+    static void FlushThread();                                   // Cada hilo, fin del run
+    static void Close();                                         // Master, fin del run
+
+  protected:
+    virtual G4bool ProcessHits(G4Step* step, G4TouchableHistory*);
+
+  private:
+    const DetectorConstruction* fDetector;
+    std::vector<PhaseSpaceRecord> fEvent; // Registros del evento actual
+};
+
+// Lectura compartida por todos los hilos: cada llamada entrega el
+// siguiente evento completo del archivo (sin repetir entre hilos).
+// Los eventos vacíos del run original no están en el archivo: la
+// normalización de una reproducción son los eventos fuente que
+// representan los registros leídos (GetSourceEvents), no los del run.
+class PhaseSpaceReader
+{
+  public:
+    // request: número de /MedidorTR/source/phaseSpace de cada hilo. Todos
+    // los hilos ejecutan el comando; solo el primero con un número nuevo
+    // abre el archivo (o lo rebobina si es el mismo)
+    static G4bool Open(const G4String& fileName, G4int request);
+    static G4bool IsOpen();
+    static G4bool NextEvent(std::vector<PhaseSpaceRecord>& records); // false al terminar
+
+    // Eventos fuente leídos en el run actual (0 = no se leyó el archivo).
+    // BeginOfRun lo llama el Master antes que los workers.
+    static void   BeginOfRun();
+    static G4long GetSourceEvents();
+
+    // Archivo completo, independiente de la lectura compartida (plegado)
+    static G4bool ReadFile(const G4String& fileName, PhaseSpaceHeader& header,
+                           std::vector<PhaseSpaceRecord>& records);
+};
+
+#endif
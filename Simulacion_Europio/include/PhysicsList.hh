@@ -3,6 +3,8 @@
 
 #include "G4VModularPhysicsList.hh" // <--- CAMBIO IMPORTANTE
 
+class G4StepLimiterPhysics;
+
 class PhysicsList: public G4VModularPhysicsList // <--- CAMBIO DE HERENCIA
 {
   public:
@@ -11,6 +13,10 @@ class PhysicsList: public G4VModularPhysicsList // <--- CAMBIO DE HERENCIA
 
   public:
     virtual void SetCuts();
+    virtual void ConstructProcess();
+
+  private:
+    G4StepLimiterPhysics* fStepLimiter; // Lo borra la lista (RegisterPhysics)
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef PrecisionMonitor_h
+#define PrecisionMonitor_h 1
+
+#include "globals.hh"
+
+class G4GenericMessenger;
+class DualEnergyIndex;
+
+// Parada adaptativa (/MedidorTR/stop/...): /run/beamOn N pasa a ser el
+// máximo y el run termina cuando el error relativo de Q (índice dual,
+// /MedidorTR/index/) alcanza el objetivo en todas las líneas. Q usa cuentas
+// netas (fondo restado con bandas laterales en las ventanas elegidas), que
+// es lo que se mide; las ROIs de /MedidorTR/roi/ son cuentas brutas y no
+// sirven como criterio de parada.
+// Cada hilo publica sus contadores cada checkEvery eventos en un registro
+// compartido; el que ve la suma bajo el objetivo aborta el run (suave: los
+// eventos en curso terminan y el Master fusiona normalmente).
+// Los comandos viven en el Master, que copia la configuración al registro
+// al empezar cada run. En un run con checkpoint (/MedidorTR/run/) el
+// Master publica además los contadores de los segmentos anteriores.
+class PrecisionMonitor
+{
+  public:
+    PrecisionMonitor();
+    ~PrecisionMonitor();
+
+    void BeginOfRun(G4int nCopies, const DualEnergyIndex& index, G4long eventsBefore);
+    void EndOfEvent(const DualEnergyIndex& index);
+    void EndOfRun(G4long nEvents) const;
+
+  private:
+    G4GenericMessenger* fMessenger; // Solo en el Master
+
+    // Configuración (Master)
+    G4double fPrecision;   // Error relativo objetivo de Q (0 = desactivado)
+    G4int    fCheckEvery;  // Eventos por hilo entre verificaciones
+    G4int    fMinEvents;   // Eventos totales antes de la primera verificación
+
+    // Estado del hilo
+    G4int fNCopies;
+    G4int fEventsSinceCheck;
+};
+
+#endif
@@ -4,16 +4,91 @@
 #include "G4VUserActionInitialization.hh"
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "G4GeneralParticleSource.hh" // Usamos GPS, es más potente
+#include "G4ThreeVector.hh"
+#include "CascadeTable.hh"
+#include "PhaseSpace.hh"
+#include <vector>
+
+class DetectorConstruction;
+class EventAction;
+class G4GenericMessenger;
+class G4PrimaryVertex;
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
   public:
-    PrimaryGeneratorAction();
+    PrimaryGeneratorAction(EventAction* eventAction);
     virtual ~PrimaryGeneratorAction();
 
     virtual void GeneratePrimaries(G4Event*);
 
+    // Sesgo angular hacia el detector (/MedidorTR/source/bias...).
+    // Muestrea una dirección de una mezcla: con probabilidad fBiasFraction
+    // dentro del cono alrededor de +Z, si no fuera de él. Devuelve el peso
+    // (emisión isotrópica / mezcla), así el resultado no queda sesgado.
+    G4bool   IsBiasEnabled() const { return fBiasEnabled; }
+    G4double SampleBiasedDirection(G4ThreeVector& direction) const;
+
+    void SetBiasHalfAngle(G4double angle);
+    void SetBiasFraction(G4double fraction);
+
+    // Fuente tabulada (/MedidorTR/source/loadTable): en lugar de crear el
+    // ion y seguir su decaimiento, cada evento sortea un patrón de la
+    // tabla de cascadas y lanza sus fotones isotrópicamente desde la
+    // posición del GPS.
+    void LoadTable(G4String fileName);
+    void SetUseTable(G4bool useTable);
+
+    // Modo de líneas (/MedidorTR/source/addLine, useLines): sobre la tabla,
+    // un solo fotón por evento de las líneas del análisis (122/344/1408
+    // keV), con peso por intensidad; el resto solo con continuumFraction.
+    void AddLine(G4double energy);
+    void ClearLines();
+    void SetContinuumFraction(G4double fraction);
+    void SetUseLines(G4bool useLines);
+
+    // Reproducción de un espacio de fases (/MedidorTR/source/phaseSpace):
+    // cada evento es un evento completo del archivo. Con recycle N > 1
+    // cada uno se usa N veces rotado al azar alrededor del eje de la línea
+    // (geometría con simetría axial), con peso 1/N.
+    void LoadPhaseSpace(G4String fileName);
+    void SetUsePhaseSpace(G4bool usePhaseSpace);
+    void SetRecycle(G4int recycle);
+
+    // Haz de la matriz de respuesta (/MedidorTR/source/beam): fotones
+    // monoenergéticos paralelos, a beamAngle del eje, repartidos en el
+    // disco de la esfera que envuelve el cristal de la línea 0
+    void SetBeamAngle(G4double angle);
+
   private:
+    G4PrimaryVertex* GenerateFromTable(G4Event* event, G4double& weight);
+    void GenerateBeam(G4Event* event);
+    void GenerateFromPhaseSpace(G4Event* event);
+    G4bool UpdateLines();
+
     G4GeneralParticleSource* fParticleGun; // Cambiamos a GeneralParticleSource
+    const DetectorConstruction* fDetector; // Para las posiciones de las líneas
+    EventAction* fEventAction;             // Recibe el peso del evento
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fBiasEnabled;   // Sesgo activado
+    G4double fBiasHalfAngle; // Semiángulo del cono (eje +Z)
+    G4double fBiasFraction;  // Probabilidad de emitir dentro del cono
+
+    CascadeTable fTable;     // Cascadas Eu-152 (una copia por hilo)
+    G4bool   fUseTable;      // Generar desde la tabla en vez del GPS
+    G4bool   fUseLines;      // Modo de líneas (requiere la tabla)
+    std::vector<G4double> fLines;  // Energías seleccionadas
+    G4double fContinuumFraction;   // Probabilidad de emitir otra línea
+
+    G4bool   fUsePhaseSpace;   // Generar desde el espacio de fases
+    G4int    fRecycle;         // Usos de cada evento del archivo
+    G4int    fPhaseSpaceUses;  // Usos del evento actual
+    G4int    fPhaseSpaceLoads; // /MedidorTR/source/phaseSpace ejecutados (ver PhaseSpaceReader)
+    std::vector<PhaseSpaceRecord> fPhaseSpaceEvent;
+
+    G4bool   fUseBeam;     // Haz de la matriz de respuesta
+    G4double fBeamEnergy;
+    G4double fBeamAngle;
 };
-#endif
\ No newline at end of file
+#endif
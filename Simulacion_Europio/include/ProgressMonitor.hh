@@ -0,0 +1,44 @@
+#ifndef ProgressMonitor_h
+#define ProgressMonitor_h 1
+
+#include "globals.hh"
+#include <atomic>
+
+class G4Run;
+class G4GenericMessenger;
+class RoiCounter;
+
+// Progreso del run en vivo (/MedidorTR/progress/...).
+// Cada hilo suma sus eventos en un contador atómico propio (uno por línea
+// de caché, sin candados) y, una vez por intervalo, publica una copia de
+// sus ROIs. Un hilo de reporte que arranca el Master imprime cada
+// `interval` segundos los eventos/s de cada hilo y del total, el ETA y las
+// cuentas de las ROIs; opcionalmente escribe un archivo de estado (JSON o
+// textfile de Prometheus) que se reemplaza en cada reporte.
+// Los comandos viven en el Master, que copia la configuración al registro
+// al empezar cada run (igual que el PrecisionMonitor).
+class ProgressMonitor
+{
+  public:
+    ProgressMonitor();
+    ~ProgressMonitor();
+
+    // fileName: archivo del run (solo para el estado)
+    void BeginOfRun(const G4Run* run, const G4String& fileName);
+    void EndOfEvent(const RoiCounter& roi);
+    void EndOfRun(const RoiCounter& roi);
+
+  private:
+    G4GenericMessenger* fMessenger; // Solo en el Master
+
+    // Configuración (Master)
+    G4double fInterval;    // Segundos entre reportes (0 = desactivado)
+    G4String fStatusFile;  // Archivo de estado ("" = solo pantalla)
+    G4String fFormat;      // "json" o "prometheus"
+
+    // Estado del hilo
+    std::atomic<G4long>* fEvents;     // Contador del hilo (nullptr = apagado)
+    G4long               fGeneration; // Último pedido de ROIs atendido
+};
+
+#endif
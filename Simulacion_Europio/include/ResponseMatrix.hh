@@ -0,0 +1,85 @@
+#ifndef ResponseMatrix_h
+#define ResponseMatrix_h 1
+
+#include "SpectrumCounter.hh"
+#include "globals.hh"
+#include <vector>
+
+class G4GenericMessenger;
+class DetectorResponse;
+
+// Matriz de respuesta del LaBr3(Ce) y plegado de espectros
+// (/MedidorTR/matrix/...).
+//
+// Generación (run, solo Master): para cada energía y bin de ángulo un run
+// con un haz paralelo monoenergético (/MedidorTR/source/beam) que cubre el
+// disco de radio R (esfera que envuelve el cristal) perpendicular al haz.
+// Cada fila es la probabilidad por fotón incidente de depositar energía en
+// cada bin (sin resolución). Se guarda en texto:
+//   # bins <n> emax_keV <E> radio_cm <R> detectorZ_cm <z>
+//   <E_keV> <cos_theta> <eventos> p_0 ... p_{n-1}
+//
+// Plegado (foldPhaseSpace, foldLines): cada fotón incidente cuya recta
+// pasa a menos de R del centro del cristal suma la fila de su energía y
+// ángulo. Entre dos energías de la matriz el continuo se interpola y el
+// fotopico se coloca en la energía exacta. Después se aplica la
+// resolución y los canales de /MedidorTR/response/ del Master. Un
+// espacio de fases multi-línea se pliega de a una línea (cada una tiene
+// su detector y su concentración).
+//
+// Limitación: cada fotón se pliega por separado, así que no hay suma de
+// coincidencias verdaderas. En el Eu-152 dos fotones de la misma cascada
+// pueden depositar juntos en el cristal; el espectro plegado no tiene
+// esos picos suma y sobrestima un poco los fotopicos. Para eso hay que
+// usar el transporte completo hasta el detector.
+//
+// Una instancia por hilo (vive en el RunAction): los workers llenan su
+// espectro mientras se genera la matriz; el del Master tiene la suma.
+class ResponseMatrix
+{
+  public:
+    ResponseMatrix(const DetectorResponse& response);
+    ~ResponseMatrix();
+
+    void Fill(G4double edep, G4double weight) { if (fRecording) fCounter.Fill(edep, weight); }
+
+    void AddEnergy(G4double energyKeV);
+    void AddEnergyRange(G4double eMinKeV, G4double eMaxKeV, G4int points);
+    void ClearEnergies();
+    void SetBinning(G4int bins, G4double eMaxKeV);
+    void Run();
+
+    G4bool Load(G4String fileName);
+    void   FoldPhaseSpace(G4String fileName, G4int line); // Solo los registros de esa línea
+    void   FoldLines(G4String fileName);
+
+  private:
+    // Fila plegada para un fotón (energía, cos theta) sumada con peso
+    void AddIncident(G4double energy, G4double cosTheta, G4double weight,
+                     std::vector<G4double>& spectrum) const;
+    void WriteSpectrum(const std::vector<G4double>& spectrum, const G4String& fileName) const;
+    G4bool Save() const;
+
+    G4GenericMessenger* fMessenger;
+    const DetectorResponse& fResponse; // Resolución y canales del plegado
+    SpectrumCounter fCounter;          // G4Accumulable: depósito del bin actual
+    G4bool fRecording;                 // Llenar fCounter (solo durante run)
+
+    // Grilla de la generación
+    std::vector<G4double> fEnergies;  // Ordenadas
+    G4int    fAngleBins;              // Bins uniformes en cos theta
+    G4double fMaxAngle;
+    G4int    fEvents;                 // Fotones por bin
+    G4int    fBins;                   // Bins de energía depositada
+    G4double fEmax;
+    G4String fFileName;
+
+    // Matriz cargada: fRows[energía][ángulo][bin]
+    std::vector<std::vector<std::vector<G4double>>> fRows;
+    std::vector<G4double> fCosTheta;  // Centros de los bins de ángulo
+    G4double fMatrixEmax;             // Borde superior del último bin
+    G4double fRadius;                 // Radio del disco del haz
+    G4double fDetectorZ;              // Centro del cristal
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef RoiCounter_h
+#define RoiCounter_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+#include <istream>
+#include <ostream>
+#include <vector>
+
+// Contadores de regiones de interés (ROI) en energía depositada.
+// Es un G4Accumulable: cada hilo suma sus eventos y el Master los fusiona
+// al final del run, sin guardar datos por evento.
+// Por cada (línea, ROI) se acumula la suma de pesos y la suma de pesos al
+// cuadrado: cuentas = sum(w), error = sqrt(sum(w^2)).
+class RoiCounter : public G4VAccumulable
+{
+  public:
+    RoiCounter(const G4String& name);
+    virtual ~RoiCounter();
+
+    void AddROI(G4double eMin, G4double eMax);
+    void Clear();
+
+    // Suma el evento en todas las ROIs que contienen edep
+    void Fill(G4int copy, G4double edep, G4double weight = 1.);
+
+    std::size_t GetNumberOfROIs() const { return fEmin.size(); }
+    G4int       GetNumberOfCopies() const;
+    G4double    GetEmin(std::size_t roi) const { return fEmin[roi]; }
+    G4double    GetEmax(std::size_t roi) const { return fEmax[roi]; }
+    G4double    GetSumW(G4int copy, std::size_t roi) const;
+    G4double    GetSumW2(G4int copy, std::size_t roi) const;
+
+    // Checkpoint (/MedidorTR/run/): una línea con las sumas. Read falla si
+    // las ROIs definidas no son las mismas que al escribir
+    void   Write(std::ostream& out) const;
+    G4bool Read(std::istream& in);
+
+    virtual void Merge(const G4VAccumulable& other);
+    virtual void Reset();
+
+  private:
+    std::vector<G4double> fEmin;
+    std::vector<G4double> fEmax;
+    // Índice = copia * nROI + roi; crece al aparecer una copia nueva
+    std::vector<G4double> fSumW;
+    std::vector<G4double> fSumW2;
+};
+
+#endif
@@ -4,8 +4,22 @@
 #include "G4UserRunAction.hh"
 #include "G4AnalysisManager.hh"
 #include "globals.hh"
+#include "RunTimer.hh"
+#include "G4Accumulable.hh"
+#include "RoiCounter.hh"
+#include "DualEnergyIndex.hh"
+#include "DetectorResponse.hh"
+#include "ResponseMatrix.hh"
+#include "PrecisionMonitor.hh"
+#include "ProgressMonitor.hh"
+#include "StepProfiler.hh"
+#include "SamplePathSD.hh"
+#include <vector>
 
 class G4Run;
+class G4GenericMessenger;
+class SteppingAction;
+class TrackingAction;
 
 class RunAction : public G4UserRunAction
 {
@@ -15,6 +29,94 @@ class RunAction : public G4UserRunAction
 
     virtual void BeginOfRunAction(const G4Run*);
     virtual void   EndOfRunAction(const G4Run*);
+
+    // Archivo de /analysis/setFileName sin ".root": base de las demás
+    // salidas del run (_ROI.csv, .phsp, .ckpt, _perfil.csv, ...)
+    static G4String GetOutputBaseName();
+
+    // Registro de la tabla de cascadas (/MedidorTR/table/record, solo Master)
+    void RecordCascadeTable(G4String fileName, G4int decays);
+
+    // Salida (/MedidorTR/output/): histogramas H1 por hilo, fusionados al
+    // final del run (por defecto), y/o la NTuple con una fila por evento
+    G4bool IsHistoOutput() const  { return fHistoOutput; }
+    G4bool IsNtupleOutput() const { return fNtupleOutput; }
+
+    // Resolución y canalización del MCA (/MedidorTR/response/), por hilo
+    const DetectorResponse& GetDetectorResponse() const { return fResponse; }
+
+    // Matriz de respuesta (/MedidorTR/matrix/): depósito sin resolución de
+    // la línea 0, solo mientras se genera la matriz
+    void FillMatrix(G4double edep, G4double weight) { fMatrix.Fill(edep, weight); }
+
+    // ROIs de energía (/MedidorTR/roi/add <Emin> <Emax>, en keV). Los
+    // llena el EventAction; el Master escribe <archivo>_ROI.csv al final.
+    void AddROI(G4double eMinKeV, G4double eMaxKeV);
+    void ClearROIs();
+    void FillROI(G4int copy, G4double edep, G4double weight)
+    {
+        fROI.Fill(copy, edep, weight);
+        fIndex.Fill(copy, edep, weight);
+    }
+
+    // Repesado (/MedidorTR/reweight/record): columnas PathE, PathL y
+    // PathProc de la NTuple de la línea copy. El EventAction copia aquí los
+    // pasos del evento antes de AddNtupleRow.
+    SamplePath& GetSamplePath(G4int copy) { return fSamplePaths[copy]; }
+
+    // Tracks eliminados por el StackingAction
+    // (0 = neutrinos, 1 = núcleos de retroceso, 2 = electrones sin alcance)
+    void CountKilledTrack(G4int reason);
+
+    // Parada adaptativa (/MedidorTR/stop/): la llama el EventAction al
+    // final de cada evento, después de llenar el índice dual
+    void CheckPrecision() { fPrecision.EndOfEvent(fIndex); }
+
+    // Progreso en vivo (/MedidorTR/progress/): un evento más de este hilo
+    void CountProgress() { fProgress.EndOfEvent(fROI); }
+
+    // Perfil por volumen, partícula y proceso (/MedidorTR/profile/): lo
+    // alimentan el SteppingAction y el TrackingAction de este hilo, que
+    // solo están registrados en los runs con el perfil encendido
+    StepProfiler* GetProfiler() { return &fProfiler; }
+
+  private:
+    void WriteROISummary(G4long nEvents) const;
+    void PrintKilledTracks(G4long nEvents) const;
+
+    // Checkpoint de runs largos (/MedidorTR/run/, ver RunCheckpoint)
+    void SaveCheckpoint(const G4String& fileName) const;
+    void LoadCheckpoint(const G4String& fileName);
+
+    // Registra (o quita) el Stepping y el Tracking del perfil en este hilo
+    void AttachProfiler(G4bool attach);
+
+    G4GenericMessenger* fMessenger;
+    G4GenericMessenger* fOutputMessenger; // En todos los hilos
+    G4bool   fHistoOutput;  // Llenar el H1 "Energy" (un bin por canal)
+    G4bool   fNtupleOutput; // Llenar la NTuple "Scoring" (una fila por evento)
+    G4int    fHistoBins;    // Número de bins del H1
+    G4double fHistoEmax;    // Energía máxima del H1 (mínima = 0)
+    RunTimer            fTimer; // Rendimiento del run (eventos/s, solo Master)
+    DetectorResponse    fResponse; // Smearing + canal del ADC
+    ResponseMatrix      fMatrix;   // Generación de la matriz y plegado
+
+    G4GenericMessenger* fROIMessenger; // En todos los hilos
+    RoiCounter          fROI;          // G4Accumulable: sum(w) y sum(w^2) por ROI
+    DualEnergyIndex     fIndex;        // Q, transmisiones y Z-score (/MedidorTR/index/)
+    PrecisionMonitor    fPrecision;    // Detiene el run al alcanzar el error pedido
+    ProgressMonitor     fProgress;     // Eventos/s por hilo, ETA y ROIs durante el run
+    StepProfiler        fProfiler;     // Pasos, tracks y tiempo por (volumen, partícula, proceso)
+    SteppingAction*     fSteppingAction;   // Del perfil (nullptr hasta el primer run que lo usa)
+    TrackingAction*     fTrackingAction;
+    G4bool              fProfilerAttached; // Registrados: el G4RunManager los borra
+
+    // Vectores ligados a la NTuple: se dimensionan una sola vez, al crearla
+    std::vector<SamplePath> fSamplePaths;
+
+    G4Accumulable<G4long> fKilledNeutrinos; // Conteo del StackingAction
+    G4Accumulable<G4long> fKilledIons;
+    G4Accumulable<G4long> fKilledCharged;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef RunCheckpoint_h
+#define RunCheckpoint_h 1
+
+#include "globals.hh"
+#include <ostream>
+
+class G4GenericMessenger;
+
+// Checkpoint y reanudación de runs largos (/MedidorTR/run/...).
+// /MedidorTR/run/beamOn N corre N eventos en segmentos de checkpointEvery
+// (un /run/beamOn por segmento). El Master no reinicia sus histogramas ni
+// contadores entre segmentos, así que al final de cada uno el .root, el
+// _ROI.csv y <archivo>.ckpt tienen el resultado acumulado hasta ahí.
+// El .ckpt guarda los contadores del Master y apunta a <archivo>.rndm, el
+// estado del motor aleatorio del Master: en MT los workers reciben sus
+// semillas de ese motor al empezar cada run, así que alcanza para seguir
+// la misma secuencia. /MedidorTR/run/resume continúa hasta N en un
+// proceso nuevo. Al completar el run se borran el .ckpt y el .rndm.
+//
+// SIGINT/SIGTERM: el run en curso se detiene (aborto suave), se escriben
+// los resultados parciales y el checkpoint, y el proceso termina con
+// código 128 + señal. Una segunda señal termina el proceso de inmediato.
+// Solo el último segmento queda en la NTuple y en el espacio de fases.
+class RunCheckpoint
+{
+  public:
+    RunCheckpoint();
+    ~RunCheckpoint();
+
+    void BeamOn(G4int nEvents);
+    void Resume();
+    G4int GetEvery() const { return fEvery; }
+
+    // Estado del run segmentado (Master, lo usa el RunAction)
+    static G4bool IsActive();         // Hay un /MedidorTR/run/beamOn en curso
+    static G4bool IsContinuing();     // Este run sigue al anterior: no reiniciar
+    static G4bool IsRestoring();      // Cargar el estado del .ckpt (resume)
+    static G4long GetEventsBefore();  // Eventos de los segmentos anteriores
+    static G4long GetTargetEvents();  // N de /MedidorTR/run/beamOn
+    static G4bool EndOfSegment(G4int nEvents); // true si viene otro segmento
+    static G4bool IsComplete();       // Terminó: objetivo o parada propia
+    static G4String GetFileName();    // <archivo>.ckpt del run actual
+    static void   WriteHeader(std::ostream& out); // También guarda el .rndm
+    static void   Remove();
+
+    // Señales (cualquier hilo)
+    static void   CheckSignal();      // Al final de cada evento
+    static G4bool IsInterrupted();
+    static void   ExitIfInterrupted(); // Master, con los archivos ya cerrados
+
+  private:
+    void Run(G4long target, G4long done, G4bool restoring);
+
+    G4GenericMessenger* fMessenger;
+    G4int fEvery; // Eventos por segmento (0 = sin checkpoints periódicos)
+};
+
+#endif
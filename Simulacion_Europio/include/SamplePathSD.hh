@@ -0,0 +1,65 @@
+#ifndef SamplePathSD_h
+#define SamplePathSD_h 1
+
+#include "G4VSensitiveDetector.hh"
+#include "globals.hh"
+#include <vector>
+
+class DetectorConstruction;
+
+// Recorrido de los fotones dentro de la muestra en un evento: un paso por
+// entrada (energía al inicio del paso, largo y proceso que lo terminó).
+// Proceso = subtipo EM de Geant4 (11 Rayl, 12 phot, 13 compt, 14 conv) o
+// 0 si el paso terminó sin interacción (borde, energía mínima...).
+struct SamplePath
+{
+    std::vector<G4double> energy;  // Unidades internas (MeV)
+    std::vector<G4double> length;  // Unidades internas (mm)
+    std::vector<G4int>    process;
+
+    void Clear() { energy.clear(); length.clear(); process.clear(); }
+};
+
+// Repesado desde un solo run de referencia (/MedidorTR/reweight/record).
+// Detector sensible en la muestra que guarda los pasos de los fotones;
+// el EventAction los copia a la NTuple junto con la energía medida. Con
+// la tabla de secciones eficaces (WriteCrossSectionTable), el análisis
+// (Root/ReweightEu152.cpp) calcula para cualquier concentración c el peso
+//   W = prod_pasos exp(-(mu(E,c) - mu(E,c0)) l) * prod_interacciones mu_p(E,c)/mu_p(E,c0)
+// Aproximaciones: el peso solo corrige los coeficientes de atenuación
+// (probabilidad de cada proceso y del camino libre). Lo que pasa después de
+// cada interacción queda como en el run de referencia c0:
+//  - distribuciones angulares de Rayleigh (factores de forma) y Compton
+//    (función de dispersión incoherente, Doppler) de la mezcla, que cambian
+//    con la fracción de átomos de REE;
+//  - fluorescencia y Auger tras el efecto fotoeléctrico (rayos X K del Ce,
+//    ~35-40 keV, bajo ambas ventanas del índice);
+//  - los electrones que nacen en la muestra y salen (raros con el corte de
+//    1 mm).
+// Pensado para el barrido fino (REE <= ~1% en masa, c0 en el medio): ahí
+// el REE aporta pocos % de las dispersiones y el error es de segundo orden.
+// Para el barrido grueso (2-5%) usar runs directos o validar contra uno.
+class SamplePathSD : public G4VSensitiveDetector
+{
+  public:
+    SamplePathSD(const G4String& name);
+    virtual ~SamplePathSD();
+
+    virtual void Initialize(G4HCofThisEvent*);
+
+    // Pasos de la línea copy en el evento actual (vacío si no hubo)
+    const SamplePath& GetPath(G4int copy) const;
+
+    // Solo Master, al final del run: coeficientes másicos por proceso de la
+    // matriz y del REE puro (cm2/g) en una grilla logarítmica de energía,
+    // más las densidades de los extremos y la concentración de cada línea
+    static void WriteCrossSectionTable(const G4String& fileName, const DetectorConstruction* detector);
+
+  protected:
+    virtual G4bool ProcessHits(G4Step* step, G4TouchableHistory*);
+
+  private:
+    std::vector<SamplePath> fPaths; // Una por línea (número de copia)
+};
+
+#endif
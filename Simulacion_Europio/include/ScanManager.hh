@@ -0,0 +1,44 @@
+#ifndef ScanManager_h
+#define ScanManager_h 1
+
+#include "globals.hh"
+#include <vector>
+
+class DetectorConstruction;
+class RunCheckpoint;
+class G4GenericMessenger;
+
+// Barrido de concentraciones REE dentro de un mismo proceso.
+// Reemplaza el bucle de run_scan.sh / run_scan_fino.sh: la física, la
+// geometría y los hilos se inicializan una sola vez y cada punto es
+// solamente un cambio de material + un /run/beamOn.
+// Con /MedidorTR/run/checkpointEvery > 0 cada punto corre con checkpoint,
+// y un punto con <archivo>.ckpt pendiente se reanuda en vez de saltarse.
+// Comandos: /MedidorTR/scan/...
+class ScanManager
+{
+  public:
+    ScanManager(DetectorConstruction* detector, RunCheckpoint* checkpoint);
+    ~ScanManager();
+
+    void Clear();
+    void AddPoint(G4double fraction);
+    void AddRange(G4double fractionMin, G4double fractionMax);
+    void Run();
+
+  private:
+    G4String FileNameFor(G4double fraction) const;
+
+    DetectorConstruction* fDetector;
+    RunCheckpoint*        fCheckpoint;
+    G4GenericMessenger*   fMessenger;
+
+    std::vector<G4double> fPoints;      // Concentraciones (fracción másica)
+    G4double              fStep;        // Paso usado por addRange
+    G4int                 fEvents;      // Eventos por punto
+    G4String              fFilePrefix;  // Prefijo del archivo de salida
+    G4bool                fSkipExisting; // Saltar puntos con archivo ya generado
+    G4bool                fPrebuiltSet; // Declarar los puntos como conjunto pre-construido
+};
+
+#endif
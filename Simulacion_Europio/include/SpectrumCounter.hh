@@ -0,0 +1,35 @@
+#ifndef SpectrumCounter_h
+#define SpectrumCounter_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+#include <vector>
+
+// Espectro de energía depositada con bins uniformes en [0, eMax).
+// Igual que RoiCounter es un G4Accumulable (cada hilo llena el suyo y el
+// Master los fusiona), pero el llenado es O(1): lo usa la matriz de
+// respuesta, que necesita el espectro completo de cada bin.
+class SpectrumCounter : public G4VAccumulable
+{
+  public:
+    SpectrumCounter(const G4String& name);
+    virtual ~SpectrumCounter();
+
+    void SetBinning(G4int bins, G4double eMax);
+    void Fill(G4double edep, G4double weight = 1.);
+
+    G4int    GetBins() const { return G4int(fSumW.size()); }
+    G4double GetEmax() const { return fEmax; }
+    G4double GetSumW(G4int bin) const  { return fSumW[bin]; }
+    G4double GetSumW2(G4int bin) const { return fSumW2[bin]; }
+
+    virtual void Merge(const G4VAccumulable& other);
+    virtual void Reset();
+
+  private:
+    G4double fEmax;
+    std::vector<G4double> fSumW;
+    std::vector<G4double> fSumW2;
+};
+
+#endif
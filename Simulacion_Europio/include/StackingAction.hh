@@ -0,0 +1,53 @@
+#ifndef StackingAction_h
+#define StackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "globals.hh"
+
+class PrimaryGeneratorAction;
+class EventAction;
+class RunAction;
+class DetectorConstruction;
+class G4GenericMessenger;
+class G4Material;
+class G4EmCalculator;
+
+// Productos del decaimiento radiactivo: reinicio del reloj (una vez por
+// track), sesgo angular de los gammas y registro de la tabla de cascadas
+// (CascadeTable).
+// Con la fuente como ion (/gps/particle ion), los gammas del Eu-152 no son
+// primarios: los crea G4RadioactiveDecay. Se les reasigna la dirección
+// aquí, antes del primer paso, con el mismo muestreo que los primarios.
+//
+// Además elimina al crearse los secundarios que nunca llegan al cristal
+// (/MedidorTR/stack/...): neutrinos, núcleos de retroceso en su estado
+// fundamental (estables) y electrones nacidos fuera del detector cuyo
+// alcance en aire es menor que la distancia al detector. Los núcleos
+// excitados y los positrones siempre se siguen. El RunAction lleva la
+// cuenta de lo eliminado.
+class StackingAction : public G4UserStackingAction
+{
+  public:
+    StackingAction(const PrimaryGeneratorAction* generator, EventAction* eventAction,
+                   RunAction* runAction);
+    virtual ~StackingAction();
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*);
+
+  private:
+    G4bool CannotScore(const G4Track* track);
+
+    const PrimaryGeneratorAction* fGenerator;
+    EventAction* fEventAction;
+    RunAction* fRunAction;
+    const DetectorConstruction* fDetector; // Se busca una sola vez
+
+    G4GenericMessenger* fMessenger;
+    G4bool fKillNeutrinos;
+    G4bool fKillIons;
+    G4bool fKillCharged;
+    G4Material* fRangeMaterial; // Aire del mundo: el alcance más largo posible
+    G4EmCalculator* fCalculator; // Se crea una sola vez (por hilo)
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef StepProfiler_h
+#define StepProfiler_h 1
+
+#include "globals.hh"
+#include <chrono>
+#include <unordered_map>
+
+class G4Step;
+class G4Track;
+class G4LogicalVolume;
+class G4ParticleDefinition;
+class G4VProcess;
+class G4GenericMessenger;
+
+// Perfil de dónde se va el tiempo de un evento (/MedidorTR/profile/...).
+// Por cada (volumen lógico, partícula, proceso) cuenta pasos, tracks y
+// tiempo real muestreado:
+//   pasos  -> volumen del pre-step y proceso que limitó el paso
+//   tracks -> volumen donde nace el track y proceso que lo creó
+//   tiempo -> uno de cada sampleEvery pasos se cronometra (desde el paso
+//             anterior del mismo track, o desde el inicio del track) y
+//             cuenta sampleEvery veces
+// Cada hilo llena su tabla (el SteppingAction y el TrackingAction solo lo
+// llaman); al final del run los workers la publican y el Master imprime
+// las N combinaciones más costosas y escribe <archivo>_perfil.csv.
+// Apagado no cuesta nada: el RunAction registra el SteppingAction y el
+// TrackingAction solo en los runs con el perfil encendido.
+class StepProfiler
+{
+  public:
+    StepProfiler();
+    ~StepProfiler();
+
+    void BeginOfRun();
+    G4bool IsEnabled() const { return fEnabled; } // En este run (después de BeginOfRun)
+    void EndOfRun(const G4String& baseName); // baseName: <archivo> sin .root
+
+    void PreTrack(const G4Track* track) { if (fEnabled) RecordTrack(track); }
+    void Step(const G4Step* step)       { if (fEnabled) RecordStep(step); }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Key
+    {
+        const G4LogicalVolume* volume;
+        const G4ParticleDefinition* particle;
+        const G4VProcess* process;
+        G4bool operator==(const Key& other) const
+        {
+            return volume == other.volume && particle == other.particle && process == other.process;
+        }
+    };
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const;
+    };
+    struct Counters
+    {
+        G4long   steps = 0;
+        G4long   tracks = 0;
+        G4double seconds = 0.; // Tiempo estimado (muestras x sampleEvery)
+    };
+
+    void RecordTrack(const G4Track* track);
+    void RecordStep(const G4Step* step);
+    Counters& Find(const Key& key);
+
+    G4GenericMessenger* fMessenger; // Solo en el Master
+
+    // Configuración (Master)
+    G4bool fEnable;
+    G4int  fSampleEvery; // Pasos entre mediciones de tiempo
+    G4int  fTop;         // Filas de la tabla impresa
+
+    // Estado del hilo
+    G4bool fEnabled;
+    G4int  fSample;
+    G4long fStepCount;
+    G4bool fArmed;       // El próximo paso se cronometra
+    Clock::time_point fStart;
+    std::unordered_map<Key, Counters, KeyHash> fTable;
+    Key       fLastKey;  // Pasos seguidos suelen repetir la clave
+    Counters* fLast;
+};
+
+#endif
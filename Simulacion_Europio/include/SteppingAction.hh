@@ -4,18 +4,20 @@
 #include "G4UserSteppingAction.hh"
 #include "globals.hh"
 
-class DetectorConstruction;
+class RunAction;
+class StepProfiler;
 
+// Solo alimenta el perfil de pasos (StepProfiler); apagado no hace nada
 class SteppingAction : public G4UserSteppingAction
 {
   public:
-    SteppingAction(const DetectorConstruction* detector);
+    SteppingAction(RunAction* runAction);
     virtual ~SteppingAction();
 
-    virtual void UserSteppingAction(const G4Step*);
+    virtual void UserSteppingAction(const G4Step* step);
 
   private:
-    const DetectorConstruction* fDetConstruction;
+    StepProfiler* fProfiler;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,23 @@
+#ifndef TrackingAction_h
+#define TrackingAction_h 1
+
+#include "G4UserTrackingAction.hh"
+#include "globals.hh"
+
+class RunAction;
+class StepProfiler;
+
+// Solo alimenta el perfil de tracks (StepProfiler); apagado no hace nada
+class TrackingAction : public G4UserTrackingAction
+{
+  public:
+    TrackingAction(RunAction* runAction);
+    virtual ~TrackingAction();
+
+    virtual void PreUserTrackingAction(const G4Track* track);
+
+  private:
+    StepProfiler* fProfiler;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TransmissionCalculator_h
+#define TransmissionCalculator_h 1
+
+#include "globals.hh"
+#include <vector>
+
+class DetectorConstruction;
+class G4GenericMessenger;
+
+// Transmisión de haz estrecho sin bucle de eventos (/MedidorTR/calc/...).
+//   T(E, c) = exp(-mu(E, c) * espesor)
+// con mu de G4EmCalculator para el mismo material de la muestra que usa
+// DetectorConstruction. Para cada concentración de la grilla da T y ln T
+// por línea, Q/Q0 con Q = T(121.78)/T(344.28) y Q0 su valor a 0% REE
+// (AnalisisEu152_v4; el punto c = 0 se agrega siempre) y
+// R = ln T(59.5) / ln T(511) (analisis_dual.cpp), con sus derivadas
+// respecto de la concentración. Es la curva de calibración de primer
+// orden contra la que se compara el MC.
+class TransmissionCalculator
+{
+  public:
+    TransmissionCalculator(DetectorConstruction* detector);
+    ~TransmissionCalculator();
+
+    void AddLine(G4double energyKeV);
+    void ClearLines();
+    void SetQLines(G4double eLowKeV, G4double eHighKeV);
+    void SetRLines(G4double eLowKeV, G4double eHighKeV);
+    void AddPoint(G4double fraction);
+    void AddRange(G4double fractionMin, G4double fractionMax);
+    void ClearPoints();
+    void Run();
+
+  private:
+    G4double Attenuation(G4double energy, G4double fraction) const; // mu (1/longitud)
+
+    DetectorConstruction* fDetector;
+    G4GenericMessenger*   fMessenger;
+
+    std::vector<G4double> fLines;   // Energías a evaluar
+    std::vector<G4double> fPoints;  // Concentraciones (fracción másica)
+    G4double fStep;                 // Paso usado por addRange
+    G4double fQLow, fQHigh;         // Líneas del índice Q
+    G4double fRLow, fRHigh;         // Líneas del índice R
+    G4String fFilePrefix;           // <prefijo>_lineas.csv y <prefijo>_indices.csv
+};
+
+#endif
@@ -15,6 +15,10 @@ if [ ! -f "$EXEC" ]; then
     exit 1
 fi
 
+# Hilos por simulación (número o auto = todos los núcleos del nodo).
+# Se puede cambiar sin editar: THREADS=auto ./run_scan.sh
+THREADS=${THREADS:-16}
+
 # Número de eventos por concentración
 NEVENTS=100000000
 
@@ -54,7 +58,7 @@ for ree in 0.00 0.01 0.02 0.03 0.04 0.05; do
 EOF
     
     # Ejecutar simulación
-    $EXEC temp_run.mac
+    $EXEC --threads $THREADS temp_run.mac
     
     # Verificar resultado
     if [ $? -ne 0 ]; then
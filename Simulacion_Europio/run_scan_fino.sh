@@ -16,10 +16,24 @@ if [ ! -f "$EXEC" ]; then
     exit 1
 fi
 
+# Hilos por simulación (número o auto = todos los núcleos del nodo).
+# Se puede cambiar sin editar: THREADS=auto ./run_scan_fino.sh
+THREADS=${THREADS:-16}
+
 # Número de eventos por concentración
 # NOTA: Para el barrido fino cerca del LOD, buena estadística es crítica
 NEVENTS=100000000
 
+# Parada adaptativa: NEVENTS pasa a ser el máximo y cada punto se detiene
+# al alcanzar este error relativo en Q (0 = correr siempre NEVENTS).
+# Los puntos lejos del LOD terminan mucho antes que los de 0.2-0.8%.
+PRECISION=0.002
+
+# Checkpoint cada CHECKPOINT eventos (<archivo>.ckpt + .rndm). Si el
+# proceso muere o recibe SIGTERM, al relanzar el script ese punto se
+# reanuda desde el último checkpoint en vez de empezar de nuevo.
+CHECKPOINT=10000000
+
 # =============================================================
 # CONCENTRACIONES A SIMULAR
 # =============================================================
@@ -51,7 +65,7 @@ CONCENTRACIONES=(
 )
 
 echo "Concentraciones a simular: ${CONCENTRACIONES[@]}"
-echo "Eventos por simulación: $NEVENTS"
+echo "Eventos por simulación: $NEVENTS (máximo; precisión objetivo en Q: $PRECISION)"
 echo "Total de simulaciones: ${#CONCENTRACIONES[@]}"
 echo ""
 
@@ -72,11 +86,18 @@ for ree in "${CONCENTRACIONES[@]}"; do
     ree_name=$(echo $ree | tr '.' 'p')
     
     # Verificar si el archivo ya existe (para poder continuar simulaciones interrumpidas)
+    # Con checkpoint pendiente el .root es parcial: se reanuda
     OUTPUT_FILE="Eu152_REE_${ree_name}.root"
-    if [ -f "$OUTPUT_FILE" ]; then
+    CKPT_FILE="Eu152_REE_${ree_name}.ckpt"
+    if [ -f "$CKPT_FILE" ]; then
+        echo "    NOTA: $CKPT_FILE encontrado, reanudando..."
+        BEAMON="/MedidorTR/run/resume"
+    elif [ -f "$OUTPUT_FILE" ]; then
         echo "    NOTA: $OUTPUT_FILE ya existe, saltando..."
         echo ""
         continue
+    else
+        BEAMON="/MedidorTR/run/beamOn $NEVENTS"
     fi
     
     # Crear macro temporal
@@ -107,17 +128,28 @@ for ree in "${CONCENTRACIONES[@]}"; do
 # --- 4. ARCHIVO DE SALIDA ---
 /analysis/setFileName Eu152_REE_${ree_name}
 
-# --- 5. EJECUTAR SIMULACIÓN ---
-/run/beamOn $NEVENTS
+# --- 5. ÍNDICE DUAL Y PARADA ADAPTATIVA (error relativo de Q) ---
+/MedidorTR/index/enable true
+/MedidorTR/stop/precision $PRECISION
+
+# --- 6. PROGRESO EN VIVO (eventos/s por hilo, ETA, ROIs) ---
+# El archivo de estado se reescribe en cada reporte: watch cat ...
+/MedidorTR/progress/interval 60
+/MedidorTR/progress/statusFile Eu152_REE_${ree_name}_estado.json
+
+# --- 7. EJECUTAR SIMULACIÓN (con checkpoint) ---
+/MedidorTR/run/checkpointEvery $CHECKPOINT
+$BEAMON
 EOF
     
     # Registrar tiempo de inicio
     START_TIME=$(date +%s)
     
     # Ejecutar simulación
-    $EXEC temp_run.mac
+    $EXEC --threads $THREADS temp_run.mac
     
     # Verificar resultado
+    # (interrumpida: código 128 + señal, el checkpoint queda para reanudar)
     if [ $? -ne 0 ]; then
         echo "ERROR en simulación con REE=$ree"
         rm -f temp_run.mac
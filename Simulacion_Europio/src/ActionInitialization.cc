@@ -2,7 +2,7 @@
 #include "PrimaryGeneratorAction.hh"
 #include "RunAction.hh"
 #include "EventAction.hh"
-#include "SteppingAction.hh"
+#include "StackingAction.hh"
 #include "DetectorConstruction.hh"
 
 ActionInitialization::ActionInitialization()
@@ -21,11 +21,21 @@ void ActionInitialization::BuildForMaster() const
 
 void ActionInitialization::Build() const
 {
-    SetUserAction(new PrimaryGeneratorAction);
-    SetUserAction(new RunAction());  // Workers también necesitan uno
-    
-    EventAction* eventAction = new EventAction();
+    RunAction* runAction = new RunAction();  // Workers también necesitan uno
+    SetUserAction(runAction);
+
+    // El EventAction va antes que el generador: el generador y el
+    // StackingAction le entregan el peso de la fuente sesgada
+    EventAction* eventAction = new EventAction(runAction);
     SetUserAction(eventAction);
-    
-    SetUserAction(new SteppingAction(nullptr)); 
+
+    PrimaryGeneratorAction* generator = new PrimaryGeneratorAction(eventAction);
+    SetUserAction(generator);
+
+    // El scoring lo hace el detector sensible y el reloj de los productos
+    // del decaimiento se reinicia en el StackingAction
+    SetUserAction(new StackingAction(generator, eventAction, runAction));
+
+    // Sin Stepping ni Tracking: solo alimentan el perfil opcional y los
+    // registra el RunAction en los runs con /MedidorTR/profile/enable true
 }
\ No newline at end of file
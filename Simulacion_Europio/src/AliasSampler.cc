@@ -0,0 +1,60 @@
+#include "AliasSampler.hh"
+
+#include "Randomize.hh"
+
+#include <algorithm>
+
+AliasSampler::AliasSampler()
+{}
+
+AliasSampler::~AliasSampler()
+{}
+
+// Vose: se reparten los pesos en N celdas de altura media 1. Las celdas
+// "pequeñas" (< 1) se completan con masa de una "grande", que queda como
+// su alias.
+void AliasSampler::Build(const std::vector<G4double>& weights)
+{
+    std::size_t n = weights.size();
+    fProbability.assign(n, 1.);
+    fAlias.resize(n);
+    for (std::size_t i = 0; i < n; i++) fAlias[i] = i;
+    if (n == 0) return;
+
+    G4double total = 0.;
+    for (G4double w : weights) total += w;
+
+    std::vector<G4double> scaled(n);
+    std::vector<std::size_t> small, large;
+    for (std::size_t i = 0; i < n; i++) {
+        scaled[i] = weights[i] * n / total;
+        if (scaled[i] < 1.) small.push_back(i);
+        else                large.push_back(i);
+    }
+
+    while (!small.empty() && !large.empty()) {
+        std::size_t s = small.back(); small.pop_back();
+        std::size_t l = large.back();
+
+        fProbability[s] = scaled[s];
+        fAlias[s] = l;
+
+        scaled[l] -= 1. - scaled[s];
+        if (scaled[l] < 1.) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Lo que queda (por redondeo) se queda con probabilidad 1
+    for (std::size_t i : small) fProbability[i] = 1.;
+    for (std::size_t i : large) fProbability[i] = 1.;
+}
+
+// Un solo número aleatorio: la parte entera elige la celda y la parte
+// fraccionaria decide entre la celda y su alias
+std::size_t AliasSampler::Sample() const
+{
+    G4double u = G4UniformRand() * fProbability.size();
+    std::size_t cell = std::min(std::size_t(u), fProbability.size() - 1);
+    return (u - cell < fProbability[cell]) ? cell : fAlias[cell];
+}
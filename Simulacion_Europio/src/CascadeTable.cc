@@ -0,0 +1,270 @@
+#include "CascadeTable.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "G4AutoLock.hh"
+#include "G4Threading.hh"
+#include "G4RunManager.hh"
+#include "G4MTRunManager.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace
+{
+    // Patrón (energías en eV, ordenadas) -> cuentas, una tabla por línea
+    using Patterns = std::map<std::vector<G4long>, G4long>;
+
+    // Registro global: el Master lo arma, cada hilo suma su tabla al final
+    // del run y el Master la escribe
+    G4Mutex recordMutex = G4MUTEX_INITIALIZER;
+    G4String recordFile;
+    G4long   recordLimit = 0;               // Decaimientos por línea (0 = todo el run)
+    G4int    recordLines = 1;
+    std::atomic<G4bool> recording(false);
+    std::atomic<G4long> recordedEvents(0);  // Eventos tomados (también los de más)
+    std::vector<Patterns> recordedPatterns;
+
+    // Tabla de cada hilo: sin bloqueo durante el run
+    G4ThreadLocal std::vector<Patterns>* threadPatterns = nullptr;
+
+    // Archivo de cada línea: el pedido con una línea, <base>_<copia><ext> con varias
+    G4String LineFileName(G4int copy)
+    {
+        if (recordLines == 1) return recordFile;
+        std::size_t dot = recordFile.rfind('.');
+        if (dot == std::string::npos) dot = recordFile.size();
+        return recordFile.substr(0, dot) + "_" + std::to_string(copy) + recordFile.substr(dot);
+    }
+}
+
+// 1. CONSTRUCTOR
+CascadeTable::CascadeTable()
+{}
+
+// 2. DESTRUCTOR
+CascadeTable::~CascadeTable()
+{}
+
+// 3. LECTURA
+G4bool CascadeTable::Load(const G4String& fileName)
+{
+    std::ifstream file(fileName);
+    if (!file.good()) {
+        G4cerr << "ERROR: no se pudo abrir la tabla de cascadas " << fileName << G4endl;
+        return false;
+    }
+
+    std::vector<std::vector<G4double>> patterns;
+    std::vector<G4double> counts;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+
+        G4double count;
+        if (!(fields >> count) || count <= 0.) continue;
+
+        std::vector<G4double> energies;
+        G4double energy;
+        while (fields >> energy) energies.push_back(energy * keV);
+
+        patterns.push_back(energies);
+        counts.push_back(count);
+    }
+
+    if (patterns.empty()) {
+        G4cerr << "ERROR: tabla de cascadas vacía: " << fileName << G4endl;
+        return false;
+    }
+
+    // Intensidad de cada línea (fotones por decaimiento), sumando todos
+    // los patrones en que aparece
+    G4double decays = 0.;
+    std::map<G4long, G4double> lineCounts;
+    for (std::size_t i = 0; i < patterns.size(); i++) {
+        decays += counts[i];
+        for (G4double energy : patterns[i]) lineCounts[std::lround(energy / eV)] += counts[i];
+    }
+    fLineEnergies.clear();
+    fLineIntensities.clear();
+    for (const auto& line : lineCounts) {
+        fLineEnergies.push_back(line.first * eV);
+        fLineIntensities.push_back(line.second / decays);
+    }
+
+    fPatterns.swap(patterns);
+    fSampler.Build(counts);
+    fEmitEnergies.clear();
+    fEmitWeights.clear();
+    return true;
+}
+
+// 4. MODO DE LÍNEAS
+G4bool CascadeTable::SelectLines(const std::vector<G4double>& energies,
+                                 G4double continuumFraction, G4double tolerance)
+{
+    std::vector<G4bool> selected(fLineEnergies.size(), false);
+    G4double intensitySelected = 0., intensityRest = 0.;
+    for (std::size_t i = 0; i < fLineEnergies.size(); i++) {
+        for (G4double energy : energies) {
+            if (std::abs(fLineEnergies[i] - energy) <= tolerance) selected[i] = true;
+        }
+        if (selected[i]) intensitySelected += fLineIntensities[i];
+        else             intensityRest += fLineIntensities[i];
+    }
+
+    if (intensitySelected <= 0.) {
+        G4cerr << "ERROR: ninguna de las líneas pedidas está en la tabla de cascadas" << G4endl;
+        return false;
+    }
+    if (intensityRest <= 0.) continuumFraction = 0.;
+
+    // Probabilidad de emisión: p_k = (1-f) I_k / I_sel para las seleccionadas,
+    // f I_j / I_resto para el resto. Peso = I_k / p_k.
+    std::vector<G4double> probabilities;
+    fEmitEnergies.clear();
+    fEmitWeights.clear();
+    for (std::size_t i = 0; i < fLineEnergies.size(); i++) {
+        G4double probability = selected[i]
+            ? (1. - continuumFraction) * fLineIntensities[i] / intensitySelected
+            : continuumFraction * fLineIntensities[i] / intensityRest;
+        if (probability <= 0.) continue;
+
+        fEmitEnergies.push_back(fLineEnergies[i]);
+        fEmitWeights.push_back(fLineIntensities[i] / probability);
+        probabilities.push_back(probability);
+    }
+    fLineSampler.Build(probabilities);
+    return true;
+}
+
+G4double CascadeTable::SampleLine(G4double& energy) const
+{
+    std::size_t i = fLineSampler.Sample();
+    energy = fEmitEnergies[i];
+    return fEmitWeights[i];
+}
+
+G4double CascadeTable::GetLineIntensity(G4double energy, G4double tolerance) const
+{
+    G4double intensity = 0.;
+    for (std::size_t i = 0; i < fLineEnergies.size(); i++) {
+        if (std::abs(fLineEnergies[i] - energy) <= tolerance) intensity += fLineIntensities[i];
+    }
+    return intensity;
+}
+
+// 5. REGISTRO
+void CascadeTable::StartRecording(const G4String& fileName, G4long decays)
+{
+    G4AutoLock lock(&recordMutex);
+    recordFile = fileName;
+    recordLimit = std::max<G4long>(0, decays);
+}
+
+// El Master empieza antes que los workers: el registro vale para este run
+void CascadeTable::BeginOfRun(G4int nLines)
+{
+    G4AutoLock lock(&recordMutex);
+    recordLines = std::max(1, nLines);
+    recordedPatterns.assign(recordLines, Patterns());
+    recordedEvents = 0;
+    recording = !recordFile.empty();
+}
+
+G4bool CascadeTable::IsRecording()
+{
+    return recording;
+}
+
+void CascadeTable::Record(const std::vector<std::vector<G4double>>& cascades)
+{
+    // Alcanzados los decaimientos pedidos: el hilo que toma el último
+    // detiene el run (aborto suave, en MT lo hace el Master)
+    G4long event = recordedEvents++;
+    if (recordLimit > 0 && event >= recordLimit) return;
+    if (recordLimit > 0 && event == recordLimit - 1) {
+        recording = false;
+        if (G4Threading::IsWorkerThread()) {
+            G4MTRunManager::GetMasterRunManager()->AbortRun(true);
+        } else {
+            G4RunManager::GetRunManager()->AbortRun(true);
+        }
+    }
+
+    if (!threadPatterns) threadPatterns = new std::vector<Patterns>;
+    if (G4int(threadPatterns->size()) < recordLines) threadPatterns->resize(recordLines);
+
+    // Un decaimiento por línea y por evento; una línea sin fotones también
+    // cuenta (patrón vacío). Redondeo a 1 eV para que la misma línea caiga
+    // siempre en el mismo patrón.
+    static const std::vector<G4double> none;
+    for (G4int copy = 0; copy < recordLines; copy++) {
+        const std::vector<G4double>& energies = copy < G4int(cascades.size()) ? cascades[copy] : none;
+        std::vector<G4long> key;
+        key.reserve(energies.size());
+        for (G4double energy : energies) key.push_back(std::lround(energy / eV));
+        std::sort(key.begin(), key.end());
+        (*threadPatterns)[copy][key]++;
+    }
+}
+
+void CascadeTable::FlushThread()
+{
+    if (!threadPatterns) return;
+
+    G4AutoLock lock(&recordMutex);
+    for (std::size_t copy = 0; copy < threadPatterns->size() && copy < recordedPatterns.size(); copy++) {
+        for (const auto& pattern : (*threadPatterns)[copy]) recordedPatterns[copy][pattern.first] += pattern.second;
+    }
+    lock.unlock();
+
+    delete threadPatterns;
+    threadPatterns = nullptr;
+}
+
+// Una vez escrita la tabla el registro se apaga: los runs siguientes no
+// registran salvo un nuevo /MedidorTR/table/record
+void CascadeTable::WriteRecording()
+{
+    G4AutoLock lock(&recordMutex);
+    if (recordFile.empty()) return;
+    recording = false;
+
+    for (G4int copy = 0; copy < G4int(recordedPatterns.size()); copy++) {
+        const Patterns& patterns = recordedPatterns[copy];
+        G4long decays = 0;
+        for (const auto& pattern : patterns) decays += pattern.second;
+
+        G4String fileName = LineFileName(copy);
+        std::ofstream file(fileName);
+        file << "# Tabla de cascadas Eu-152 (generada con /MedidorTR/table/record)\n";
+        if (recordLines > 1) file << "# linea: " << copy << "\n";
+        file << "# decaimientos: " << decays
+             << " | patrones: " << patterns.size() << "\n";
+        file << "# cuentas  E1[keV] E2[keV] ...\n";
+        file.precision(9);
+        for (const auto& pattern : patterns) {
+            file << pattern.second;
+            for (G4long energy : pattern.first) file << " " << energy * 1.e-3;
+            file << "\n";
+        }
+
+        G4cout << ">>> Tabla de cascadas escrita en " << fileName << ": "
+               << patterns.size() << " patrones de " << decays
+               << " decaimientos" << G4endl;
+        if (recordLimit > 0 && decays < recordLimit) {
+            G4cerr << "WARNING: tabla de cascadas con " << decays << " de " << recordLimit
+                   << " decaimientos pedidos (run más corto)" << G4endl;
+        }
+    }
+
+    recordFile.clear();
+    recordLimit = 0;
+    recordedPatterns.clear();
+}
@@ -10,14 +10,50 @@
 #include "G4VisAttributes.hh"
 #include "G4Color.hh"
 #include "G4GenericMessenger.hh" 
+#include "G4UImanager.hh"
+#include "G4UserLimits.hh"
+#include "G4SDManager.hh"
+#include "G4MultiFunctionalDetector.hh"
+#include "G4PSEnergyDeposit.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "LeptonUserLimits.hh"
+#include "SamplePathSD.hh"
+#include "PhaseSpace.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 // 1. CONSTRUCTOR
 DetectorConstruction::DetectorConstruction()
 : G4VUserDetectorConstruction(), 
   fREEFraction(0.0), 
+  fREESetPrepared(0),
   fApatiteWithREE(nullptr),
   fLogicSample(nullptr),
-  fLogicDetector(nullptr) // <--- AÑADE ESTO (Inicializar a nulo)
+  fLogicDetector(nullptr), // <--- AÑADE ESTO (Inicializar a nulo)
+  fLogicPhaseSpace(nullptr),
+  fNumBeamlines(1),
+  fBeamlinePitch(40.0*cm),
+  fAbsorberThickness(2.0*cm),
+  fSampleThickness(5.0*cm),
+  fDetectorZ(15.0*cm),
+  fDetectorBoundingRadius(0.),
+  fRegionMessenger(nullptr),
+  fCutWorld(10.0*cm),
+  fCutSample(1.0*mm),
+  fCutDetector(0.1*mm),
+  fEminWorld(10.0*keV),
+  fEminSample(10.0*keV),
+  fEminDetector(0.),
+  fReweightMessenger(nullptr),
+  fRecordPaths(false),
+  fPhaseSpaceMessenger(nullptr),
+  fPhaseSpacePlane(false),
+  fPhaseSpaceZ(3.5*cm),
+  fKillAtPlane(true)
 {
     // Crear el mensajero
     fMessenger = new G4GenericMessenger(this, "/MedidorTR/det/", "Control del Detector");
@@ -29,11 +65,88 @@ DetectorConstruction::DetectorConstruction()
     fMessenger->DeclareMethod("setREE", 
                               &DetectorConstruction::SetREEConcentration, 
                               "Set REE concentration (mass fraction 0.0 - 1.0)");
+
+    // Conjunto pre-construido: se declara antes del barrido y todas las
+    // tablas de sección eficaz se construyen en una sola preparación
+    fMessenger->DeclareMethod("addREEToSet",
+                              &DetectorConstruction::AddREEToSet,
+                              "Declare a REE concentration of the pre-built material set")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("prepareREESet",
+                              &DetectorConstruction::PrepareREESet,
+                              "Build cross-section tables for every material of the set")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_Idle);
+
+    // Multi-línea: N copias aisladas de fuente/muestra/detector en un solo run
+    fMessenger->DeclareProperty("setBeamlines", fNumBeamlines,
+                                "Number of replicated source/sample/detector lines")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fMessenger->DeclarePropertyWithUnit("setBeamlinePitch", "cm", fBeamlinePitch,
+                                        "Distance along X between beamline axes")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fMessenger->DeclareMethod("setBeamlineREE",
+                              &DetectorConstruction::SetBeamlineREE,
+                              "Set REE concentration of one beamline: <copy> <mass fraction>")
+        .SetToBeBroadcasted(false);
+
+    // Regiones: se fijan antes de /run/initialize (la geometría es del Master)
+    fRegionMessenger = new G4GenericMessenger(this, "/MedidorTR/regions/", "Cortes por región");
+    fRegionMessenger->DeclarePropertyWithUnit("cutWorld", "mm", fCutWorld,
+                                              "Corte de producción en el aire del mundo")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fRegionMessenger->DeclarePropertyWithUnit("cutSample", "mm", fCutSample,
+                                              "Corte de producción en la muestra")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fRegionMessenger->DeclarePropertyWithUnit("cutDetector", "mm", fCutDetector,
+                                              "Corte de producción en el cristal")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fRegionMessenger->DeclarePropertyWithUnit("eminWorld", "keV", fEminWorld,
+                                              "Energía mínima de seguimiento de e-/e+ en el mundo")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fRegionMessenger->DeclarePropertyWithUnit("eminSample", "keV", fEminSample,
+                                              "Energía mínima de seguimiento de e-/e+ en la muestra")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fRegionMessenger->DeclarePropertyWithUnit("eminDetector", "keV", fEminDetector,
+                                              "Energía mínima de seguimiento de e-/e+ en el cristal")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+
+    // Repesado: el detector sensible se crea en ConstructSDandField
+    fReweightMessenger = new G4GenericMessenger(this, "/MedidorTR/reweight/", "Repesado desde un run de referencia");
+    fReweightMessenger->DeclareProperty("record", fRecordPaths,
+                                        "Guardar los pasos de los fotones en la muestra (requiere /MedidorTR/output/ntuple true)")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+
+    // Espacio de fases: el plano es geometría, se pide antes de /run/initialize
+    fPhaseSpaceMessenger = new G4GenericMessenger(this, "/MedidorTR/phsp/", "Espacio de fases muestra -> detector");
+    fPhaseSpaceMessenger->DeclareProperty("plane", fPhaseSpacePlane,
+                                          "Plano de registro entre muestra y detector (escribe <archivo>.phsp)")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fPhaseSpaceMessenger->DeclarePropertyWithUnit("planeZ", "cm", fPhaseSpaceZ,
+                                                  "Posición Z del plano (entre la cara de salida de la muestra y el detector)")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_PreInit);
+    fPhaseSpaceMessenger->DeclareProperty("killAtPlane", fKillAtPlane,
+                                          "Detener las partículas al registrarlas (no simular el detector)")
+        .SetToBeBroadcasted(false);
 }
 
 // 2. DESTRUCTOR
 DetectorConstruction::~DetectorConstruction()
 {
+    delete fPhaseSpaceMessenger;
+    delete fReweightMessenger;
+    delete fRegionMessenger;
     delete fMessenger; 
 }
 
@@ -59,27 +172,49 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
         G4cerr << "ERROR CRÍTICO: No se encontró el material LaBr3(Ce)" << G4endl;
         return nullptr;
     }
+    // Dimensiones de la muestra (se necesitan para validar la separación)
+    G4double sampleX = 20.0 * cm; 
+    G4double sampleY = 20.0 * cm; 
+    G4double sampleZ = fSampleThickness;
+
+    if (fNumBeamlines < 1) fNumBeamlines = 1;
+    if (fNumBeamlines > 1 && fBeamlinePitch < sampleX + fAbsorberThickness) {
+        G4cerr << "ERROR: setBeamlinePitch debe ser >= " << (sampleX + fAbsorberThickness)/cm
+               << " cm. Usando ese valor." << G4endl;
+        fBeamlinePitch = sampleX + fAbsorberThickness;
+    }
+    fBeamlineREE.resize(fNumBeamlines, -1.);
+
     // --- A. VOLUMEN MUNDO ---
+    // Con N líneas el mundo crece en X para alojarlas una al lado de la otra
     G4double worldSize = 1.0 * m;
-    G4Box* solidWorld = new G4Box("World", worldSize/2, worldSize/2, worldSize/2);
+    G4double worldX = std::max(worldSize, fNumBeamlines * fBeamlinePitch);
+    G4Box* solidWorld = new G4Box("World", worldX/2, worldSize/2, worldSize/2);
     G4LogicalVolume* logicWorld = new G4LogicalVolume(solidWorld, worldMat, "World");
     G4VPhysicalVolume* physWorld = new G4PVPlacement(0, G4ThreeVector(), logicWorld, "World", 0, false, 0, true);
 
     // --- B. VOLUMEN DE LA MUESTRA (El Apatito) ---
     // Está en el centro (0,0,0) con espesor 5cm (de -2.5 a +2.5 cm en Z)
-    G4double sampleX = 20.0 * cm; 
-    G4double sampleY = 20.0 * cm; 
-    G4double sampleZ = 5.0 * cm;  
-
+    // Con N líneas, la copia i está en X = GetBeamlineOffset(i); cada una
+    // tiene su propio volumen lógico porque su material es distinto.
     G4Box* solidSample = new G4Box("Sample", sampleX/2, sampleY/2, sampleZ/2);
-    fLogicSample = new G4LogicalVolume(solidSample, fApatiteWithREE, "Sample");
-    new G4PVPlacement(0, G4ThreeVector(0,0,0), fLogicSample, "Sample", logicWorld, false, 0, true);
+    fLogicSamples.clear();
+    for (G4int i = 0; i < fNumBeamlines; i++) {
+        G4Material* material = (i == 0 || fBeamlineREE[i] < 0.)
+                             ? fApatiteWithREE
+                             : BuildApatiteWithREE(fBeamlineREE[i]);
+        G4LogicalVolume* logicSample = new G4LogicalVolume(solidSample, material, "Sample");
+        new G4PVPlacement(0, G4ThreeVector(GetBeamlineOffset(i),0,0), logicSample, "Sample", logicWorld, false, i, true);
+        fLogicSamples.push_back(logicSample);
+    }
+    fLogicSample = fLogicSamples[0];
 
     // --- CONSTRUCCIÓN DEL VOLUMEN DEL DETECTOR ---
 
     // Ejemplo de geometría típica de 2x2 pulgadas o similar
     G4double det_R = 2.54*cm; // Radio
     G4double det_Z = 2.54*cm; // Semialtura (Largo total = ~5cm)
+    fDetectorBoundingRadius = std::sqrt(det_R*det_R + det_Z*det_Z);
 
     G4Tubs* solidDetector = new G4Tubs("SolidDetector", 
                                    0.*cm,    // Radio interno
@@ -102,28 +237,105 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
     
     //fLogicDetector = new G4LogicalVolume(solidDet, detMat, "Detector");
     
-    new G4PVPlacement(0, 
-                      G4ThreeVector(0, 0, 15.0*cm), // Posición Z = +15 cm
-                      fLogicDetector, 
-                      "LogicDetector",//"Detector", // Era el de NaI(Tl)
-                      logicWorld, 
-                      false, 
-                      0, 
-                      true);
+    // El número de copia identifica la línea: el scoring se separa por él
+    for (G4int i = 0; i < fNumBeamlines; i++) {
+        new G4PVPlacement(0, 
+                          G4ThreeVector(GetBeamlineOffset(i), 0, fDetectorZ), // Posición Z = +15 cm
+                          fLogicDetector, 
+                          "LogicDetector",//"Detector", // Era el de NaI(Tl)
+                          logicWorld, 
+                          false, 
+                          i, 
+                          true);
+    }
+
+    // --- C1. PLANO DEL ESPACIO DE FASES ---
+    // Lámina de aire de 1 mm que cubre toda la línea (hasta las paredes
+    // entre líneas); una copia por línea, igual que muestra y detector
+    if (fPhaseSpacePlane) {
+        G4double planeHalfZ = 0.5*mm;
+        G4double zMin = sampleZ/2 + planeHalfZ;
+        G4double zMax = fDetectorZ - det_Z - planeHalfZ;
+        if (fPhaseSpaceZ < zMin || fPhaseSpaceZ > zMax) {
+            G4cerr << "ERROR: planeZ debe estar entre " << zMin/cm << " y " << zMax/cm
+                   << " cm. Usando " << zMin/cm + 1. << " cm." << G4endl;
+            fPhaseSpaceZ = zMin + 1.*cm;
+        }
+        G4double planeX = (fNumBeamlines > 1) ? fBeamlinePitch - fAbsorberThickness : worldX;
+        G4Box* solidPlane = new G4Box("PhaseSpacePlane", planeX/2, worldSize/2, planeHalfZ);
+        fLogicPhaseSpace = new G4LogicalVolume(solidPlane, worldMat, "PhaseSpacePlane");
+        for (G4int i = 0; i < fNumBeamlines; i++) {
+            new G4PVPlacement(0, G4ThreeVector(GetBeamlineOffset(i), 0, fPhaseSpaceZ),
+                              fLogicPhaseSpace, "PhaseSpacePlane", logicWorld, false, i, true);
+        }
+    }
+
+    // --- C2. ABSORBENTES ENTRE LÍNEAS ---
+    // Paredes que cubren todo el alto y largo del mundo entre dos líneas
+    // vecinas. G4UserLimits con energía mínima infinita hace que cualquier
+    // partícula que entre muera en el acto (absorbente perfecto, requiere
+    // G4StepLimiterPhysics en el PhysicsList), así ninguna línea ve a otra.
+    G4LogicalVolume* logicAbsorber = nullptr;
+    if (fNumBeamlines > 1) {
+        G4Box* solidAbsorber = new G4Box("Absorber", fAbsorberThickness/2, worldSize/2, worldSize/2);
+        logicAbsorber = new G4LogicalVolume(solidAbsorber, nist->FindOrBuildMaterial("G4_Pb"), "Absorber");
+        logicAbsorber->SetUserLimits(new G4UserLimits(DBL_MAX, DBL_MAX, DBL_MAX, DBL_MAX));
+
+        for (G4int i = 0; i < fNumBeamlines - 1; i++) {
+            G4double x = GetBeamlineOffset(i) + fBeamlinePitch/2;
+            new G4PVPlacement(0, G4ThreeVector(x, 0, 0), logicAbsorber, "Absorber", logicWorld, false, i, true);
+        }
+    }
+
+    // --- C3. REGIONES ---
+    ConstructRegions();
 
     // --- D. VISUALIZACIÓN ---
     G4VisAttributes* sampleVis = new G4VisAttributes(G4Color(0.0, 1.0, 1.0, 0.6)); // Cyan
     sampleVis->SetForceSolid(true);
-    fLogicSample->SetVisAttributes(sampleVis);
+    for (G4LogicalVolume* logicSample : fLogicSamples) {
+        logicSample->SetVisAttributes(sampleVis);
+    }
     
     G4VisAttributes* detVis = new G4VisAttributes(G4Color(1.0, 0.0, 0.0, 0.5)); // Rojo semi-transparente
     detVis->SetForceSolid(true);
     fLogicDetector->SetVisAttributes(detVis);
 
+    if (logicAbsorber) {
+        G4VisAttributes* absVis = new G4VisAttributes(G4Color(0.5, 0.5, 0.5, 0.3)); // Gris
+        logicAbsorber->SetVisAttributes(absVis);
+    }
+
     return physWorld; 
 }
 
-// 4. DEFINICIÓN DE MATERIALES (Tu código, con pequeña optimización)
+// 4. DETECTOR SENSIBLE
+// Se llama en cada hilo. El scorer de energía depositada solo se ejecuta
+// en los pasos dentro del cristal (el resto del mundo no paga nada) y
+// acumula por número de copia del detector, es decir, por línea.
+void DetectorConstruction::ConstructSDandField()
+{
+    auto detector = new G4MultiFunctionalDetector("Detector");
+    G4SDManager::GetSDMpointer()->AddNewDetector(detector);
+    detector->RegisterPrimitive(new G4PSEnergyDeposit("eDep"));
+    SetSensitiveDetector(fLogicDetector, detector);
+
+    // Pasos de los fotones en cada muestra (número de copia = línea)
+    if (fRecordPaths) {
+        auto samplePath = new SamplePathSD("SamplePath");
+        G4SDManager::GetSDMpointer()->AddNewDetector(samplePath);
+        for (G4LogicalVolume* logicSample : fLogicSamples) SetSensitiveDetector(logicSample, samplePath);
+    }
+
+    // Partículas que cruzan el plano del espacio de fases
+    if (fLogicPhaseSpace) {
+        auto phaseSpace = new PhaseSpaceWriter("PhaseSpace", this);
+        G4SDManager::GetSDMpointer()->AddNewDetector(phaseSpace);
+        SetSensitiveDetector(fLogicPhaseSpace, phaseSpace);
+    }
+}
+
+// 5. DEFINICIÓN DE MATERIALES (Tu código, con pequeña optimización)
 void DetectorConstruction::DefineMaterials() {
     G4NistManager* nist = G4NistManager::Instance();
 
@@ -169,13 +381,27 @@ void DetectorConstruction::DefineMaterials() {
     // PARTE 2: MATERIAL VARIABLE (Se ejecuta SIEMPRE)
     // =========================================================
     // Esta parte DEBE ejecutarse cada vez que cambias la concentración
-    
+    fApatiteWithREE = BuildApatiteWithREE(fREEFraction);
+
+    // Materiales del conjunto declarado (si lo hay): se crean todos de una vez
+    for (G4double fraction : fREESet) {
+        BuildApatiteWithREE(fraction);
+    }
+
+    // Actualizar los volúmenes lógicos si ya están construidos
+    UpdateSampleMaterials();
+}
+
+// 6. MATERIAL DOPADO PARA UNA CONCENTRACIÓN
+G4Material* DetectorConstruction::BuildApatiteWithREE(G4double fraction) {
+    G4NistManager* nist = G4NistManager::Instance();
+
     // Recuperamos los punteros que necesitamos (seguro porque ya pasamos la Parte 1)
     G4Material* apatiteBase = G4Material::GetMaterial("ApatiteBase");
     G4Material* reeMaterial = nist->FindOrBuildMaterial("G4_Ce"); 
 
     // Definimos el nombre único para esta concentración
-    G4String matName = "Apatite_doped_" + std::to_string(fREEFraction);
+    G4String matName = "Apatite_doped_" + std::to_string(fraction);
     
     // Verificamos si ESTA concentración específica ya existe para no duplicarla
     // (Esto evita el warning "duplicate name" en esa parte)
@@ -183,32 +409,200 @@ void DetectorConstruction::DefineMaterials() {
     
     if (existingMat) {
         // Si ya existe (ej: volviste a 0% después de probar 5%), úsalo.
-        fApatiteWithREE = existingMat;
-    } else {
-        // Si es nuevo, calcúlalo y créalo
-        G4double density = 3.19*g/cm3 * (1.0 - fREEFraction) + 6.77*g/cm3 * fREEFraction;
-        
-        fApatiteWithREE = new G4Material(matName, density, 2);
-        fApatiteWithREE->AddMaterial(apatiteBase, 1.0 - fREEFraction);
-        fApatiteWithREE->AddMaterial(reeMaterial, fREEFraction);
-        
-        G4cout << "--> Material Nuevo Creado: " << matName << G4endl;
+        return existingMat;
+    }
+
+    // Si es nuevo, calcúlalo y créalo
+    G4double density = GetSampleDensity(fraction);
+    
+    G4Material* material = new G4Material(matName, density, 2);
+    material->AddMaterial(apatiteBase, 1.0 - fraction);
+    material->AddMaterial(reeMaterial, fraction);
+    
+    G4cout << "--> Material Nuevo Creado: " << matName << G4endl;
+    return material;
+}
+
+G4double DetectorConstruction::GetSampleDensity(G4double fraction) const {
+    return 3.19*g/cm3 * (1.0 - fraction) + 6.77*g/cm3 * fraction;
+}
+
+// 7. CONJUNTO PRE-CONSTRUIDO
+G4bool DetectorConstruction::IsInREESet(G4double fraction) const {
+    for (G4double declared : fREESet) {
+        if (std::abs(declared - fraction) < 1.e-9) return true;
+    }
+    return false;
+}
+
+void DetectorConstruction::AddREEToSet(G4double fraction) {
+    if (fraction < 0. || fraction > 1.) {
+        G4cerr << "ERROR: concentración fuera de rango [0,1]: " << fraction << G4endl;
+        return;
+    }
+    if (IsInREESet(fraction)) return;
+    fREESet.push_back(fraction);
+
+    // Después de /run/initialize el material se crea en el acto;
+    // antes, lo crea DefineMaterials junto con el resto.
+    if (fLogicSample) BuildApatiteWithREE(fraction);
+}
+
+void DetectorConstruction::PrepareREESet() {
+    if (!fLogicSample) {
+        G4cerr << "ERROR: prepareREESet requiere /run/initialize" << G4endl;
+        return;
     }
 
-    // Actualizar el volumen lógico si ya está construido
-    if(fLogicSample) {
-        fLogicSample->SetMaterial(fApatiteWithREE);
-        // IMPORTANTE: Avisar al RunManager que la geometría cambió
-        //G4RunManager::GetRunManager()->GeometryHasBeenModified();
+    // Las parejas material-corte (y sus tablas) solo se crean para los
+    // materiales de las regiones. Cada material del conjunto se cuelga de
+    // la región "Sample" con un volumen lógico propio SIN colocar (no está
+    // en la geometría, solo en la lista de materiales de la región), así
+    // una sola inicialización de la física construye todas las tablas.
+    G4Region* sample = G4RegionStore::GetInstance()->GetRegion("Sample", false);
+    if (!sample) {
+        G4cerr << "ERROR: prepareREESet sin la región Sample" << G4endl;
+        return;
+    }
+    if (fREESetPrepared == fREESet.size()) return;
+
+    G4cout << "--> Preparando tablas para " << fREESet.size() - fREESetPrepared
+           << " concentraciones REE..." << G4endl;
+
+    G4Box* holderSolid = new G4Box("REESetHolder", 1.*um, 1.*um, 1.*um);
+    for (; fREESetPrepared < fREESet.size(); fREESetPrepared++) {
+        G4Material* material = BuildApatiteWithREE(fREESet[fREESetPrepared]);
+        auto holder = new G4LogicalVolume(holderSolid, material, "REESetHolder_" + material->GetName());
+        sample->AddRootLogicalVolume(holder);
     }
+
+    // Mismo mecanismo que SetREEConcentration (llega también a los workers);
+    // BeamOn(0): solo inicialización en el Master, sin eventos
+    G4UImanager::GetUIpointer()->ApplyCommand("/run/physicsModified");
+    G4RunManager::GetRunManager()->BeamOn(0);
 }
 
-// 5. UPDATE
+// 8. UPDATE
 void DetectorConstruction::SetREEConcentration(G4double fraction) {
     fREEFraction = fraction;
+
+    // Modo conjunto pre-construido: la geometría no cambia, solo el puntero
+    // del material. Las tablas ya existen, así que la re-inicialización de la
+    // física no reconstruye nada (/run/physicsModified llega también a los workers).
+    if (fLogicSample && IsInREESet(fraction)) {
+        fApatiteWithREE = BuildApatiteWithREE(fraction);
+        UpdateSampleMaterials();
+        G4UImanager::GetUIpointer()->ApplyCommand("/run/physicsModified");
+        return;
+    }
+
     DefineMaterials(); 
     G4RunManager::GetRunManager()->GeometryHasBeenModified();
     // CAMBIO CRÍTICO: Usar ReinitializeGeometry en lugar de GeometryHasBeenModified
     // Esto fuerza una reconstrucción completa incluyendo las tablas de física
     //G4RunManager::GetRunManager()->ReinitializeGeometry(true, false);
-}
\ No newline at end of file
+}
+
+// 9. MULTI-LÍNEA
+G4double DetectorConstruction::GetBeamlineOffset(G4int copy) const {
+    // Líneas centradas en X = 0 (con una sola línea, la geometría original)
+    return (copy - 0.5*(fNumBeamlines - 1)) * fBeamlinePitch;
+}
+
+G4int DetectorConstruction::GetBeamlineAt(G4double x) const {
+    if (fNumBeamlines <= 1) return 0;
+    G4int copy = G4int(std::floor(x / fBeamlinePitch + 0.5*fNumBeamlines));
+    return std::min(std::max(copy, 0), fNumBeamlines - 1);
+}
+
+G4double DetectorConstruction::GetDistanceToDetector(const G4ThreeVector& point) const {
+    G4double distance = DBL_MAX;
+    for (G4int i = 0; i < fNumBeamlines; i++) {
+        G4ThreeVector center(GetBeamlineOffset(i), 0, fDetectorZ);
+        distance = std::min(distance, (point - center).mag() - fDetectorBoundingRadius);
+    }
+    return std::max(distance, 0.);
+}
+
+G4double DetectorConstruction::GetBeamlineREE(G4int copy) const {
+    if (copy <= 0 || copy >= G4int(fBeamlineREE.size()) || fBeamlineREE[copy] < 0.) {
+        return fREEFraction;
+    }
+    return fBeamlineREE[copy];
+}
+
+G4Material* DetectorConstruction::GetBeamlineMaterial(G4int copy) const {
+    if (copy < 0 || copy >= G4int(fLogicSamples.size())) return nullptr;
+    return fLogicSamples[copy]->GetMaterial();
+}
+
+// La línea 0 y las que no tienen setBeamlineREE siguen a setREE
+void DetectorConstruction::UpdateSampleMaterials() {
+    for (std::size_t i = 0; i < fLogicSamples.size(); i++) {
+        if (i == 0 || i >= fBeamlineREE.size() || fBeamlineREE[i] < 0.) {
+            fLogicSamples[i]->SetMaterial(fApatiteWithREE);
+        }
+    }
+}
+
+void DetectorConstruction::SetBeamlineREE(G4int copy, G4double fraction) {
+    if (copy < 0 || copy >= fNumBeamlines) {
+        G4cerr << "ERROR: línea " << copy << " no existe (setBeamlines = "
+               << fNumBeamlines << ")" << G4endl;
+        return;
+    }
+    if (fraction < 0. || fraction > 1.) {
+        G4cerr << "ERROR: concentración fuera de rango [0,1]: " << fraction << G4endl;
+        return;
+    }
+
+    // La línea 0 es la muestra "de siempre"
+    if (copy == 0) {
+        SetREEConcentration(fraction);
+        return;
+    }
+
+    if (G4int(fBeamlineREE.size()) < fNumBeamlines) fBeamlineREE.resize(fNumBeamlines, -1.);
+    fBeamlineREE[copy] = fraction;
+
+    // Ya construida: solo cambia el material de esa copia
+    if (copy < G4int(fLogicSamples.size())) {
+        fLogicSamples[copy]->SetMaterial(BuildApatiteWithREE(fraction));
+        G4UImanager::GetUIpointer()->ApplyCommand("/run/physicsModified");
+    }
+}
+
+// 10. REGIONES
+// Fuera del cristal solo importan los fotones: con cortes grandes y una
+// energía mínima los electrones del aire y de la muestra depositan su
+// energía en el acto. El cristal conserva el corte fino para el espectro.
+// La energía mínima la aplica G4UserSpecialCuts (G4StepLimiterPhysics)
+// y vale solo para electrones y positrones (LeptonUserLimits).
+// Los absorbentes tienen sus propios G4UserLimits, que tienen prioridad.
+void DetectorConstruction::ConstructRegions()
+{
+    G4RegionStore* store = G4RegionStore::GetInstance();
+
+    G4Region* world = store->GetRegion("DefaultRegionForTheWorld", false);
+    if (world) world->SetUserLimits(new LeptonUserLimits(fEminWorld));
+
+    G4Region* sample = store->GetRegion("Sample", false);
+    if (!sample) sample = new G4Region("Sample");
+    for (G4LogicalVolume* logicSample : fLogicSamples) sample->AddRootLogicalVolume(logicSample);
+    G4ProductionCuts* sampleCuts = new G4ProductionCuts();
+    sampleCuts->SetProductionCut(fCutSample);
+    sample->SetProductionCuts(sampleCuts);
+    sample->SetUserLimits(new LeptonUserLimits(fEminSample));
+
+    G4Region* detector = store->GetRegion("Detector", false);
+    if (!detector) detector = new G4Region("Detector");
+    detector->AddRootLogicalVolume(fLogicDetector);
+    G4ProductionCuts* detectorCuts = new G4ProductionCuts();
+    detectorCuts->SetProductionCut(fCutDetector);
+    detector->SetProductionCuts(detectorCuts);
+    detector->SetUserLimits(new LeptonUserLimits(fEminDetector));
+
+    G4cout << "--> Regiones: mundo " << fCutWorld/mm << " mm / " << fEminWorld/keV
+           << " keV, muestra " << fCutSample/mm << " mm / " << fEminSample/keV
+           << " keV, detector " << fCutDetector/mm << " mm / " << fEminDetector/keV << " keV" << G4endl;
+}
@@ -0,0 +1,215 @@
+#include "DualEnergyIndex.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4AccumulableManager.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+// 1. CONSTRUCTOR
+DualEnergyIndex::DualEnergyIndex()
+: fMessenger(nullptr),
+  fCounter("LineROI"),
+  fEnabled(false),
+  fELow(121.78*keV),
+  fEHigh(344.28*keV),
+  fWLow(12.*keV),
+  fWHigh(20.*keV),
+  fReferenceFile("Indice_referencia.txt"),
+  fResultsFile("Indice_resultados.csv"),
+  fHasReference(false),
+  fRefLow(0.), fRefLowErr(0.),
+  fRefHigh(0.), fRefHighErr(0.)
+{
+    G4AccumulableManager::Instance()->RegisterAccumulable(&fCounter);
+    UpdateROIs();
+
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/index/", "Índice dual-energy en línea");
+    fMessenger->DeclareProperty("enable", fEnabled,
+                                "Calcular Q y Z-score al final de cada run");
+    fMessenger->DeclareMethod("setLines", &DualEnergyIndex::SetLines,
+                              "Líneas baja y alta: <Elow> <Ehigh> en keV (ej. 121.78 344.28)");
+    fMessenger->DeclareMethod("setWindows", &DualEnergyIndex::SetWindows,
+                              "Semiancho de las ventanas: <wLow> <wHigh> en keV (ej. 12 20)");
+    fMessenger->DeclareProperty("referenceFile", fReferenceFile,
+                                "Archivo con la referencia 0% REE");
+    fMessenger->DeclareProperty("resultsFile", fResultsFile,
+                                "CSV al que se agrega una fila por run (y por línea)");
+}
+
+// 2. DESTRUCTOR
+DualEnergyIndex::~DualEnergyIndex()
+{
+    delete fMessenger;
+}
+
+// 3. CONFIGURACIÓN
+void DualEnergyIndex::SetLines(G4double eLowKeV, G4double eHighKeV)
+{
+    fELow = eLowKeV*keV;
+    fEHigh = eHighKeV*keV;
+    UpdateROIs();
+}
+
+void DualEnergyIndex::SetWindows(G4double wLowKeV, G4double wHighKeV)
+{
+    if (wLowKeV <= 0. || wHighKeV <= 0.) {
+        G4cerr << "ERROR: las ventanas deben ser > 0 keV" << G4endl;
+        return;
+    }
+    fWLow = wLowKeV*keV;
+    fWHigh = wHighKeV*keV;
+    UpdateROIs();
+}
+
+// Por línea: pico [E-w, E+w), banda izquierda [E-2w, E-w), banda derecha
+// [E+w, E+2w). Las bandas suman el mismo ancho que el pico.
+void DualEnergyIndex::UpdateROIs()
+{
+    fCounter.Clear();
+    const G4double energies[2] = {fELow, fEHigh};
+    const G4double windows[2] = {fWLow, fWHigh};
+    for (G4int line = 0; line < 2; line++) {
+        G4double e = energies[line], w = windows[line];
+        fCounter.AddROI(e - w, e + w);
+        fCounter.AddROI(e - 2*w, e - w);
+        fCounter.AddROI(e + w, e + 2*w);
+    }
+}
+
+// 4. LLENADO (workers)
+void DualEnergyIndex::Fill(G4int copy, G4double edep, G4double weight)
+{
+    if (fEnabled) fCounter.Fill(copy, edep, weight);
+}
+
+// 5. CUENTAS NETAS
+// Error con pesos: var = sum(w^2) del pico + sum(w^2) de las bandas
+DualEnergyIndex::Line DualEnergyIndex::NetCounts(const RoiCounter& counter, G4int copy, G4int line)
+{
+    std::size_t first = 3 * line;
+    Line result;
+    result.net = counter.GetSumW(copy, first)
+               - counter.GetSumW(copy, first + 1) - counter.GetSumW(copy, first + 2);
+    result.error = std::sqrt(counter.GetSumW2(copy, first)
+                             + counter.GetSumW2(copy, first + 1) + counter.GetSumW2(copy, first + 2));
+    return result;
+}
+
+// Error relativo de Q = N_low / N_high; > 1 si alguna línea no tiene cuentas netas
+G4double DualEnergyIndex::GetRelativeErrorQ(const RoiCounter& counter, G4int copy)
+{
+    Line low = NetCounts(counter, copy, 0);
+    Line high = NetCounts(counter, copy, 1);
+    if (low.net <= 0. || high.net <= 0.) return 2.;
+    return std::sqrt(std::pow(low.error/low.net, 2) + std::pow(high.error/high.net, 2));
+}
+
+// 6. REFERENCIA 0% REE
+G4bool DualEnergyIndex::LoadReference()
+{
+    std::ifstream file(fReferenceFile);
+    if (!file.good()) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        if (fields >> fRefLow >> fRefLowErr >> fRefHigh >> fRefHighErr) {
+            fHasReference = true;
+            G4cout << ">>> [Master] Referencia 0% REE leída de " << fReferenceFile << G4endl;
+            return true;
+        }
+    }
+    return false;
+}
+
+void DualEnergyIndex::SaveReference() const
+{
+    std::ofstream file(fReferenceFile);
+    file << "# Referencia 0% REE (por evento simulado)\n";
+    file << "# N_low errN_low N_high errN_high\n";
+    file.precision(12);
+    file << fRefLow << " " << fRefLowErr << " " << fRefHigh << " " << fRefHighErr << "\n";
+}
+
+// 7. FIN DEL RUN (Master)
+void DualEnergyIndex::EndOfRun(G4long nEvents, const DetectorConstruction* detector,
+                               const G4String& fileName)
+{
+    if (!fEnabled || nEvents == 0) return;
+
+    G4int nBeamlines = detector->GetNumberOfBeamlines();
+
+    // Primero la referencia: una línea con REE = 0 en este run reemplaza
+    // la guardada (en multi-línea sirve para las demás del mismo run)
+    // Sin cuentas netas en alguna línea (p. ej. un run que solo graba el
+    // espacio de fases) no hay referencia: se conserva la guardada
+    for (G4int copy = 0; copy < nBeamlines; copy++) {
+        if (detector->GetBeamlineREE(copy) > 1.e-12) continue;
+        Line low = NetCounts(fCounter, copy, 0);
+        Line high = NetCounts(fCounter, copy, 1);
+        if (low.net <= 0. || high.net <= 0.) {
+            G4cerr << "WARNING: la línea " << copy << " (REE = 0) no tiene cuentas netas; "
+                   << "no se reemplaza " << fReferenceFile << G4endl;
+            continue;
+        }
+        fRefLow = low.net / nEvents;      fRefLowErr = low.error / nEvents;
+        fRefHigh = high.net / nEvents;    fRefHighErr = high.error / nEvents;
+        fHasReference = true;
+        SaveReference();
+        break;
+    }
+    if (!fHasReference) LoadReference();
+
+    G4double Q0 = 0., errQ0 = 0.;
+    if (fHasReference && fRefLow > 0. && fRefHigh > 0.) {
+        Q0 = fRefLow / fRefHigh;
+        errQ0 = Q0 * std::sqrt(std::pow(fRefLowErr/fRefLow, 2) + std::pow(fRefHighErr/fRefHigh, 2));
+    }
+
+    G4bool newFile = !std::ifstream(fResultsFile).good();
+    std::ofstream csv(fResultsFile, std::ios::app);
+    if (newFile) {
+        csv << "archivo,linea,REE,eventos,N_low,errN_low,N_high,errN_high,"
+               "Q,errQ,T_low,errT_low,T_high,errT_high,Z_score\n";
+    }
+
+    for (G4int copy = 0; copy < nBeamlines; copy++) {
+        Line low = NetCounts(fCounter, copy, 0);
+        Line high = NetCounts(fCounter, copy, 1);
+        if (low.net <= 0. || high.net <= 0.) {
+            G4cerr << "WARNING: índice dual sin cuentas netas en la línea " << copy << G4endl;
+            continue;
+        }
+
+        G4double relLow = low.error / low.net;
+        G4double relHigh = high.error / high.net;
+        G4double Q = low.net / high.net;
+        G4double errQ = Q * std::sqrt(relLow*relLow + relHigh*relHigh);
+
+        // Transmisiones y Z-score contra la referencia (por evento simulado)
+        G4double Tlow = 0., errTlow = 0., Thigh = 0., errThigh = 0., Z = 0.;
+        if (fHasReference && fRefLow > 0. && fRefHigh > 0.) {
+            Tlow = (low.net / nEvents) / fRefLow;
+            Thigh = (high.net / nEvents) / fRefHigh;
+            errTlow = Tlow * std::sqrt(relLow*relLow + std::pow(fRefLowErr/fRefLow, 2));
+            errThigh = Thigh * std::sqrt(relHigh*relHigh + std::pow(fRefHighErr/fRefHigh, 2));
+            G4double sigma = std::sqrt(errQ*errQ + errQ0*errQ0);
+            if (sigma > 0.) Z = (Q - Q0) / sigma;
+        }
+
+        csv << fileName << "," << copy << "," << detector->GetBeamlineREE(copy) << ","
+            << nEvents << "," << low.net << "," << low.error << "," << high.net << "," << high.error << ","
+            << Q << "," << errQ << "," << Tlow << "," << errTlow << ","
+            << Thigh << "," << errThigh << "," << Z << "\n";
+
+        G4cout << ">>> [Master] Linea " << copy << " REE = " << detector->GetBeamlineREE(copy)
+               << ": Q = " << Q << " +/- " << errQ;
+        if (fHasReference) G4cout << " | Z = " << Z;
+        G4cout << G4endl;
+    }
+}
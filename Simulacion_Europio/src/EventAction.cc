@@ -1,11 +1,24 @@
 #include "EventAction.hh"
 #include "RunAction.hh"
+#include "CascadeTable.hh"
+#include "SamplePathSD.hh"
+#include "PhaseSpace.hh"
+#include "RunCheckpoint.hh"
 #include "G4AnalysisManager.hh"
 #include "G4Event.hh"
+#include "G4SDManager.hh"
+#include "G4THitsMap.hh"
 
-EventAction::EventAction()
+#include <algorithm>
+
+EventAction::EventAction(RunAction* runAction)
 : G4UserEventAction(),
-  fEdep(0.)
+  fRunAction(runAction),
+  fEdepHCID(-1),
+  fSamplePathSD(nullptr),
+  fPhaseSpace(nullptr),
+  fEdep(1, 0.),
+  fWeight(1, 1.)
 {}
 
 EventAction::~EventAction()
@@ -13,18 +26,72 @@ EventAction::~EventAction()
 
 void EventAction::BeginOfEventAction(const G4Event*)
 {
-  fEdep = 0.;
+  std::fill(fEdep.begin(), fEdep.end(), 0.);
 }
 
-void EventAction::EndOfEventAction(const G4Event*)
+void EventAction::EndOfEventAction(const G4Event* event)
 {
   auto analysisManager = G4AnalysisManager::Instance();
 
+  // Evento abortado (espacio de fases agotado): no cuenta para nada
+  if (event->IsAborted()) {
+    std::fill(fWeight.begin(), fWeight.end(), 1.);
+    return;
+  }
+
+  // Energía depositada por copia del detector (ver ConstructSDandField)
+  if (fEdepHCID < 0) {
+    fEdepHCID = G4SDManager::GetSDMpointer()->GetCollectionID("Detector/eDep");
+    fSamplePathSD = static_cast<const SamplePathSD*>
+        (G4SDManager::GetSDMpointer()->FindSensitiveDetector("SamplePath", false));
+    fPhaseSpace = static_cast<PhaseSpaceWriter*>
+        (G4SDManager::GetSDMpointer()->FindSensitiveDetector("PhaseSpace", false));
+  }
+  G4HCofThisEvent* hce = event->GetHCofThisEvent();
+  auto edepMap = hce ? static_cast<G4THitsMap<G4double>*>(hce->GetHC(fEdepHCID)) : nullptr;
+  if (edepMap) {
+    for (const auto& entry : *edepMap->GetMap()) AddEdep(*entry.second, entry.first);
+  }
+
   // OPTIMIZACIÓN: Solo guardar si hubo impacto real (> 0).
   // Con 1 Millón de eventos, cada hilo verá al menos unos 300 impactos,
   // así que no habrá archivos vacíos y no fallará.
-  if (fEdep > 0.) { 
-      analysisManager->FillNtupleDColumn(0, fEdep); // Columna 0
-      analysisManager->AddNtupleRow(); // Cerrar fila
+  // Un histograma y una NTuple por línea (id = número de copia del detector)
+  // Se guarda la energía medida: resolución del LaBr3 + canal del MCA
+  const DetectorResponse& response = fRunAction->GetDetectorResponse();
+  G4bool fillHisto = fRunAction->IsHistoOutput();
+  G4bool fillNtuple = fRunAction->IsNtupleOutput();
+  for (std::size_t copy = 0; copy < fEdep.size(); copy++) {
+    if (fEdep[copy] <= 0.) continue;
+    if (copy == 0) fRunAction->FillMatrix(fEdep[copy], fWeight[copy]);
+
+    G4double energy = response.Apply(fEdep[copy]);
+    if (energy <= 0.) continue;
+
+    fRunAction->FillROI(copy, energy, fWeight[copy]);
+
+    if (fillHisto) {
+        analysisManager->FillH1(copy, energy, fWeight[copy]);
+    }
+    if (fillNtuple) {
+        analysisManager->FillNtupleDColumn(copy, 0, energy); // Columna 0
+        analysisManager->FillNtupleDColumn(copy, 1, fWeight[copy]); // Columna 1: peso
+        if (fSamplePathSD) fRunAction->GetSamplePath(copy) = fSamplePathSD->GetPath(copy);
+        analysisManager->AddNtupleRow(copy); // Cerrar fila
+    }
   }
+
+  fRunAction->CheckPrecision();
+  fRunAction->CountProgress();
+  RunCheckpoint::CheckSignal(); // SIGINT/SIGTERM: detener el run
+
+  // Un decaimiento = un patrón (también los que no emiten fotones)
+  if (CascadeTable::IsRecording()) CascadeTable::Record(fCascade);
+  for (auto& cascade : fCascade) cascade.clear();
+
+  // Espacio de fases: registros del evento con su peso final
+  if (fPhaseSpace) fPhaseSpace->FinishEvent(fWeight);
+
+  // El peso del próximo evento empieza en 1 (ver EventAction.hh)
+  std::fill(fWeight.begin(), fWeight.end(), 1.);
 }
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include "PhaseSpace.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4StepPoint.hh"
+#include "G4VTouchable.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4AutoLock.hh"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    // Escritura: un solo archivo, los hilos vuelcan su buffer bajo mutex
+    G4Mutex writeMutex = G4MUTEX_INITIALIZER;
+    std::ofstream writeFile;
+    PhaseSpaceHeader writeHeader;
+
+    // Buffer y eventos de cada hilo todavía no volcados
+    G4ThreadLocal std::vector<PhaseSpaceRecord>* threadBuffer = nullptr;
+    G4ThreadLocal G4long threadEvents = 0;
+    const std::size_t flushSize = 100000;
+
+    // Lectura: un registro de adelanto para detectar el fin de cada evento
+    G4Mutex readMutex = G4MUTEX_INITIALIZER;
+    std::ifstream readFile;
+    G4String readName;
+    PhaseSpaceRecord readAhead;
+    G4bool hasReadAhead = false;
+    G4bool endReported = false;
+    G4int  openRequest = 0;
+    PhaseSpaceHeader readHeader;
+
+    // Normalización: registros leídos desde que se abrió y al empezar el run
+    G4long readRecords = 0;
+    G4long runStartRecords = 0;
+
+    // Eventos fuente que representan los primeros `records` registros
+    G4long SourceEventsUpTo(G4long records, G4bool exhausted)
+    {
+        if (exhausted) return readHeader.sourceEvents;
+        if (readHeader.records <= 0) return 0;
+        return std::llround(G4double(readHeader.sourceEvents) * records / readHeader.records);
+    }
+
+    void WriteBuffer(std::vector<PhaseSpaceRecord>& buffer, G4long events)
+    {
+        G4AutoLock lock(&writeMutex);
+        if (writeFile.is_open() && !buffer.empty()) {
+            writeFile.write(reinterpret_cast<const char*>(buffer.data()),
+                            buffer.size() * sizeof(PhaseSpaceRecord));
+        }
+        writeHeader.records += buffer.size();
+        writeHeader.sourceEvents += events;
+        buffer.clear();
+    }
+}
+
+// 1. CONSTRUCTOR
+PhaseSpaceWriter::PhaseSpaceWriter(const G4String& name, const DetectorConstruction* detector)
+: G4VSensitiveDetector(name),
+  fDetector(detector)
+{}
+
+// 2. DESTRUCTOR
+PhaseSpaceWriter::~PhaseSpaceWriter()
+{}
+
+// 3. EVENTO
+void PhaseSpaceWriter::Initialize(G4HCofThisEvent*)
+{
+    fEvent.clear();
+}
+
+// Solo al entrar al plano y hacia el detector: lo que vuelve del
+// detector (retrodispersión) no se registra
+G4bool PhaseSpaceWriter::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+    G4StepPoint* pre = step->GetPreStepPoint();
+    if (pre->GetStepStatus() != fGeomBoundary) return false;
+    const G4ThreeVector& direction = pre->GetMomentumDirection();
+    if (direction.z() <= 0.) return false;
+
+    G4Track* track = step->GetTrack();
+    G4int line = pre->GetTouchable()->GetCopyNumber();
+    const G4ThreeVector& position = pre->GetPosition();
+
+    PhaseSpaceRecord record;
+    record.newEvent = fEvent.empty() ? 1 : 0;
+    record.line = line;
+    record.pdg = track->GetDefinition()->GetPDGEncoding();
+    record.energy = pre->GetKineticEnergy() / MeV;
+    record.x = (position.x() - fDetector->GetBeamlineOffset(line)) / mm;
+    record.y = position.y() / mm;
+    record.z = position.z() / mm;
+    record.u = direction.x();
+    record.v = direction.y();
+    record.w = direction.z();
+    record.weight = 1.;
+    fEvent.push_back(record);
+
+    // Sin transporte en el detector: se reproduce después
+    if (fDetector->IsKillAtPlane()) track->SetTrackStatus(fStopAndKill);
+    return true;
+}
+
+void PhaseSpaceWriter::FinishEvent(const std::vector<G4double>& weights)
+{
+    if (!threadBuffer) threadBuffer = new std::vector<PhaseSpaceRecord>;
+
+    for (PhaseSpaceRecord& record : fEvent) {
+        if (record.line < G4int(weights.size())) record.weight = weights[record.line];
+        threadBuffer->push_back(record);
+    }
+    threadEvents++;
+
+    if (threadBuffer->size() >= flushSize) FlushThread();
+}
+
+// 4. ARCHIVO DE SALIDA
+void PhaseSpaceWriter::Open(const G4String& fileName, G4double planeZ)
+{
+    G4AutoLock lock(&writeMutex);
+    if (writeFile.is_open()) writeFile.close();
+
+    std::memcpy(writeHeader.magic, "PHSP", 4);
+    writeHeader.version = 1;
+    writeHeader.sourceEvents = 0;
+    writeHeader.records = 0;
+    writeHeader.planeZ = planeZ / mm;
+
+    writeFile.open(fileName, std::ios::binary | std::ios::trunc);
+    if (!writeFile.good()) {
+        G4cerr << "ERROR: no se pudo crear el espacio de fases " << fileName << G4endl;
+        return;
+    }
+    // Encabezado provisorio: los totales se escriben al cerrar
+    writeFile.write(reinterpret_cast<const char*>(&writeHeader), sizeof(writeHeader));
+    G4cout << ">>> [Master] Espacio de fases -> " << fileName << G4endl;
+}
+
+void PhaseSpaceWriter::FlushThread()
+{
+    if (!threadBuffer) return;
+    WriteBuffer(*threadBuffer, threadEvents);
+    threadEvents = 0;
+}
+
+void PhaseSpaceWriter::Close()
+{
+    G4AutoLock lock(&writeMutex);
+    if (!writeFile.is_open()) return;
+
+    writeFile.seekp(0);
+    writeFile.write(reinterpret_cast<const char*>(&writeHeader), sizeof(writeHeader));
+    writeFile.close();
+    G4cout << ">>> [Master] Espacio de fases: " << writeHeader.records << " partículas de "
+           << writeHeader.sourceEvents << " eventos" << G4endl;
+}
+
+// 5. LECTURA
+// Todos los hilos ejecutan el comando: solo el primero abre el archivo.
+// Un comando nuevo con el mismo archivo lo vuelve a leer desde el inicio.
+G4bool PhaseSpaceReader::Open(const G4String& fileName, G4int request)
+{
+    G4AutoLock lock(&readMutex);
+    if (request <= openRequest) return readFile.is_open() && readName == fileName;
+    openRequest = request;
+    if (readFile.is_open()) readFile.close();
+    readFile.clear();
+
+    readFile.open(fileName, std::ios::binary);
+    PhaseSpaceHeader& header = readHeader;
+    if (!readFile.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::strncmp(header.magic, "PHSP", 4) != 0) {
+        G4cerr << "ERROR: " << fileName << " no es un espacio de fases" << G4endl;
+        readFile.close();
+        return false;
+    }
+    readName = fileName;
+    hasReadAhead = false;
+    endReported = false;
+    readRecords = 0;
+    runStartRecords = 0;
+
+    G4cout << ">>> Espacio de fases " << fileName << ": " << header.records
+           << " partículas de " << header.sourceEvents << " eventos (plano Z = "
+           << header.planeZ / 10. << " cm)" << G4endl;
+    return true;
+}
+
+G4bool PhaseSpaceReader::IsOpen()
+{
+    G4AutoLock lock(&readMutex);
+    return readFile.is_open();
+}
+
+G4bool PhaseSpaceReader::NextEvent(std::vector<PhaseSpaceRecord>& records)
+{
+    G4AutoLock lock(&readMutex);
+    records.clear();
+    if (!readFile.is_open()) return false;
+
+    if (!hasReadAhead) {
+        if (!readFile.read(reinterpret_cast<char*>(&readAhead), sizeof(readAhead))) {
+            if (!endReported) G4cout << ">>> Fin del espacio de fases " << readName << G4endl;
+            endReported = true;
+            return false;
+        }
+    }
+    records.push_back(readAhead);
+    hasReadAhead = false;
+
+    // Hasta el primer registro del evento siguiente (queda de adelanto)
+    PhaseSpaceRecord record;
+    while (readFile.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        if (record.newEvent) {
+            readAhead = record;
+            hasReadAhead = true;
+            break;
+        }
+        records.push_back(record);
+    }
+    readRecords += records.size();
+    return true;
+}
+
+void PhaseSpaceReader::BeginOfRun()
+{
+    G4AutoLock lock(&readMutex);
+    runStartRecords = readRecords;
+}
+
+// Con el archivo agotado se completan los eventos del encabezado (los
+// vacíos del final no tienen registros)
+G4long PhaseSpaceReader::GetSourceEvents()
+{
+    G4AutoLock lock(&readMutex);
+    if (!readFile.is_open() || readRecords == runStartRecords) return 0;
+    return SourceEventsUpTo(readRecords, endReported) - SourceEventsUpTo(runStartRecords, false);
+}
+
+G4bool PhaseSpaceReader::ReadFile(const G4String& fileName, PhaseSpaceHeader& header,
+                                  std::vector<PhaseSpaceRecord>& records)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::strncmp(header.magic, "PHSP", 4) != 0) {
+        G4cerr << "ERROR: " << fileName << " no es un espacio de fases" << G4endl;
+        return false;
+    }
+    records.resize(header.records);
+    file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(PhaseSpaceRecord));
+    records.resize(file.gcount() / sizeof(PhaseSpaceRecord));
+    return true;
+}
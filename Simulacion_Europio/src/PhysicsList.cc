@@ -2,26 +2,51 @@
 #include "G4EmStandardPhysics_option4.hh"
 #include "G4DecayPhysics.hh"
 #include "G4RadioactiveDecayPhysics.hh"
+#include "G4StepLimiterPhysics.hh"
 #include "G4SystemOfUnits.hh" // <--- FALTABA ESTO PARA LEER 'mm'
+#include "G4RunManager.hh"
+#include "DetectorConstruction.hh"
 
 PhysicsList::PhysicsList() 
-: G4VModularPhysicsList() // <--- CAMBIO A MODULAR
+: G4VModularPhysicsList(), // <--- CAMBIO A MODULAR
+  fStepLimiter(nullptr)
 {
   // Ahora sí podemos usar RegisterPhysics porque somos una G4VModularPhysicsList
   RegisterPhysics(new G4EmStandardPhysics_option4());
   RegisterPhysics(new G4DecayPhysics());
   RegisterPhysics(new G4RadioactiveDecayPhysics());
+
+  // G4UserLimits: energía mínima de e-/e+ en las regiones y, en modo
+  // multi-línea, absorbentes entre líneas. Solo cargadas salvo que haya
+  // absorbentes (ver ConstructProcess)
+  fStepLimiter = new G4StepLimiterPhysics();
+  RegisterPhysics(fStepLimiter);
 }
 
 PhysicsList::~PhysicsList()
 { 
 }
 
+// La geometría ya está construida (/run/initialize la hace antes que la
+// física): con absorbentes también los gammas deben morir al entrar en
+// ellos (ApplyToAll); con una sola línea bastan las cargadas.
+void PhysicsList::ConstructProcess()
+{
+  auto detector = static_cast<const DetectorConstruction*>
+      (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  fStepLimiter->SetApplyToAll(detector && detector->GetNumberOfBeamlines() > 1);
+
+  G4VModularPhysicsList::ConstructProcess();
+}
+
 void PhysicsList::SetCuts()
 {
   // Definir el rango de corte de producción (Production Cut)
-  // Esto dice: "No generes partículas secundarias si viajan menos de 0.1 mm"
-  SetDefaultCutValue(0.1*mm); 
+  // El corte por defecto es el del mundo (/MedidorTR/regions/cutWorld);
+  // la muestra y el cristal tienen el suyo en su G4Region
+  auto detector = static_cast<const DetectorConstruction*>
+      (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  SetDefaultCutValue(detector ? detector->GetWorldCut() : 0.1*mm); 
 
   // Aplicar los cortes a las tablas de física
   G4VModularPhysicsList::SetCuts();
@@ -0,0 +1,161 @@
+#include "PrecisionMonitor.hh"
+#include "RoiCounter.hh"
+#include "DualEnergyIndex.hh"
+
+#include "G4RunManager.hh"
+#include "G4MTRunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+namespace
+{
+    // Registro global: configuración del run y contadores publicados por hilo
+    G4Mutex monitorMutex = G4MUTEX_INITIALIZER;
+    G4double targetPrecision = 0.;
+    G4int    checkEvery = 10000;
+    G4long   minEvents = 0;
+
+    std::map<G4int, RoiCounter> published;  // Hilo -> copia de sus contadores
+    std::map<G4int, G4long>     publishedEvents;
+    G4bool   targetReached = false;
+    G4long   reachedAtEvents = 0;
+    G4double lastPrecision = -1.;
+
+    // Clave de los segmentos anteriores (no es id de ningún hilo)
+    const G4int kPreviousSegments = std::numeric_limits<G4int>::min();
+
+    // Peor error relativo de Q entre todas las líneas; > 1 si alguna no
+    // tiene cuentas netas, para que el run nunca se detenga por eso
+    G4double WorstRelativeError(const RoiCounter& total, G4int nCopies)
+    {
+        G4double worst = 0.;
+        for (G4int copy = 0; copy < nCopies; copy++) {
+            worst = std::max(worst, DualEnergyIndex::GetRelativeErrorQ(total, copy));
+        }
+        return worst;
+    }
+}
+
+// 1. CONSTRUCTOR
+PrecisionMonitor::PrecisionMonitor()
+: fMessenger(nullptr),
+  fPrecision(0.),
+  fCheckEvery(10000),
+  fMinEvents(1000000),
+  fNCopies(1),
+  fEventsSinceCheck(0)
+{
+    if (!G4Threading::IsMasterThread()) return;
+
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/stop/", "Parada adaptativa por precisión");
+    fMessenger->DeclareProperty("precision", fPrecision,
+                                "Error relativo objetivo de Q (ej. 0.005); 0 = correr todos los eventos de beamOn")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareProperty("checkEvery", fCheckEvery,
+                                "Eventos por hilo entre verificaciones")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareProperty("minEvents", fMinEvents,
+                                "Eventos totales mínimos antes de poder detener el run")
+        .SetToBeBroadcasted(false);
+}
+
+// 2. DESTRUCTOR
+PrecisionMonitor::~PrecisionMonitor()
+{
+    delete fMessenger;
+}
+
+// 3. INICIO DEL RUN
+// El Master empieza antes que los workers: publica la configuración y
+// limpia el registro del run anterior
+void PrecisionMonitor::BeginOfRun(G4int nCopies, const DualEnergyIndex& index, G4long eventsBefore)
+{
+    fNCopies = std::max(1, nCopies);
+    fEventsSinceCheck = 0;
+    if (!G4Threading::IsMasterThread()) return;
+
+    G4AutoLock lock(&monitorMutex);
+    targetPrecision = fPrecision;
+
+    // Sin índice no hay error que controlar: no se arma
+    if (targetPrecision > 0. && !index.IsEnabled()) {
+        G4cerr << "WARNING: /MedidorTR/stop/precision con el índice apagado "
+               << "(/MedidorTR/index/enable true); sin parada por precisión" << G4endl;
+        targetPrecision = 0.;
+    }
+    checkEvery = std::max(1, fCheckEvery);
+    minEvents = fMinEvents;
+    published.clear();
+    publishedEvents.clear();
+    targetReached = false;
+    reachedAtEvents = 0;
+    lastPrecision = -1.;
+
+    // Checkpoint: los contadores del Master traen los segmentos anteriores
+    if (eventsBefore > 0) {
+        published.emplace(kPreviousSegments, index.GetCounter());
+        publishedEvents[kPreviousSegments] = eventsBefore;
+    }
+}
+
+// 4. VERIFICACIÓN (hilo que procesa eventos)
+void PrecisionMonitor::EndOfEvent(const DualEnergyIndex& index)
+{
+    if (targetPrecision <= 0.) return;
+    if (++fEventsSinceCheck < checkEvery) return;
+
+    const RoiCounter& counter = index.GetCounter();
+    G4int thread = G4Threading::G4GetThreadId();
+
+    G4AutoLock lock(&monitorMutex);
+    if (targetReached) return;
+
+    publishedEvents[thread] += fEventsSinceCheck;
+    fEventsSinceCheck = 0;
+    published.erase(thread);
+    published.emplace(thread, counter);
+
+    G4long events = 0;
+    for (const auto& entry : publishedEvents) events += entry.second;
+    if (events < minEvents) return;
+
+    RoiCounter total(published.begin()->second);
+    for (auto it = std::next(published.begin()); it != published.end(); ++it) total.Merge(it->second);
+
+    lastPrecision = WorstRelativeError(total, fNCopies);
+    if (lastPrecision > targetPrecision) return;
+
+    targetReached = true;
+    reachedAtEvents = events;
+    lock.unlock();
+
+    // Aborto suave: en MT lo hace el Master para todos los workers
+    if (G4Threading::IsWorkerThread()) {
+        G4MTRunManager::GetMasterRunManager()->AbortRun(true);
+    } else {
+        G4RunManager::GetRunManager()->AbortRun(true);
+    }
+}
+
+// 5. INFORME (Master)
+void PrecisionMonitor::EndOfRun(G4long nEvents) const
+{
+    G4AutoLock lock(&monitorMutex);
+    if (targetPrecision <= 0.) return;
+
+    if (targetReached) {
+        G4cout << ">>> [Master] Precisión " << lastPrecision * 100. << "% <= "
+               << fPrecision * 100. << "% tras ~" << reachedAtEvents << " eventos; run detenido con "
+               << nEvents << " eventos" << G4endl;
+    } else {
+        G4cout << ">>> [Master] Precisión objetivo " << fPrecision * 100.
+               << "% no alcanzada con " << nEvents << " eventos";
+        if (lastPrecision >= 0.) G4cout << " (última: " << lastPrecision * 100. << "%)";
+        G4cout << G4endl;
+    }
+}
@@ -1,16 +1,46 @@
 #include "PrimaryGeneratorAction.hh"
+#include "DetectorConstruction.hh"
+#include "EventAction.hh"
 
 #include "G4Event.hh"
 #include "G4GeneralParticleSource.hh" // Usamos GPS
 #include "G4SystemOfUnits.hh"
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4Gamma.hh"
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "Randomize.hh"
+#include "G4RandomDirection.hh"
+#include "G4Threading.hh"
+#include "G4MTRunManager.hh"
+
+#include <algorithm>
+#include <cmath>
 
 // --- CONSTRUCTOR ---
 // Nota: Aquí estaba tu error, decías "PrimaryGenerator::" en lugar de "PrimaryGeneratorAction::"
-PrimaryGeneratorAction::PrimaryGeneratorAction()
+PrimaryGeneratorAction::PrimaryGeneratorAction(EventAction* eventAction)
 : G4VUserPrimaryGeneratorAction(),
-  fParticleGun(nullptr)
+  fParticleGun(nullptr),
+  fDetector(nullptr),
+  fEventAction(eventAction),
+  fMessenger(nullptr),
+  fBiasEnabled(false),
+  fBiasHalfAngle(15.*deg),
+  fBiasFraction(0.9),
+  fUseTable(false),
+  fUseLines(false),
+  fContinuumFraction(0.),
+  fUsePhaseSpace(false),
+  fRecycle(1),
+  fPhaseSpaceUses(0),
+  fPhaseSpaceLoads(0),
+  fUseBeam(false),
+  fBeamEnergy(121.78*keV),
+  fBeamAngle(0.)
 {
     // Crear la fuente (GPS)
     fParticleGun = new G4GeneralParticleSource();
@@ -20,18 +50,381 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
     G4ParticleTable* particleTable = G4ParticleTable::GetParticleTable();
     G4ParticleDefinition* particle = particleTable->FindParticle("gamma");
     fParticleGun->SetParticleDefinition(particle);
+
+    // Sesgo angular (solo fuente puntual fuera del detector, emisión isotrópica)
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/source/", "Control de la fuente");
+    fMessenger->DeclareProperty("bias", fBiasEnabled,
+                                "Emitir los gammas preferentemente en un cono hacia +Z (con pesos)");
+    fMessenger->DeclareMethodWithUnit("biasHalfAngle", "deg",
+                                      &PrimaryGeneratorAction::SetBiasHalfAngle,
+                                      "Semiángulo del cono de sesgo alrededor de +Z");
+    fMessenger->DeclareMethod("biasFraction",
+                              &PrimaryGeneratorAction::SetBiasFraction,
+                              "Probabilidad de emitir dentro del cono (0 < f < 1)");
+
+    // Fuente tabulada de cascadas Eu-152 (ver CascadeTable.hh)
+    fMessenger->DeclareMethod("loadTable", &PrimaryGeneratorAction::LoadTable,
+                              "Cargar la tabla de cascadas y generar desde ella");
+    fMessenger->DeclareMethod("useTable", &PrimaryGeneratorAction::SetUseTable,
+                              "Generar desde la tabla cargada (false: usar el GPS)");
+
+    // Modo de líneas (sobre la tabla)
+    fMessenger->DeclareMethodWithUnit("addLine", "keV", &PrimaryGeneratorAction::AddLine,
+                                      "Agregar una línea de la tabla a emitir (ej. 121.78 keV)");
+    fMessenger->DeclareMethod("clearLines", &PrimaryGeneratorAction::ClearLines,
+                              "Borrar la lista de líneas");
+    fMessenger->DeclareMethod("continuumFraction", &PrimaryGeneratorAction::SetContinuumFraction,
+                              "Probabilidad de emitir una línea no seleccionada (0: nunca)");
+    fMessenger->DeclareMethod("useLines", &PrimaryGeneratorAction::SetUseLines,
+                              "Emitir solo las líneas seleccionadas, con pesos");
+
+    // Espacio de fases escrito con /MedidorTR/phsp/plane (ver PhaseSpace.hh)
+    fMessenger->DeclareMethod("phaseSpace", &PrimaryGeneratorAction::LoadPhaseSpace,
+                              "Abrir un espacio de fases (.phsp) y generar desde él");
+    fMessenger->DeclareMethod("usePhaseSpace", &PrimaryGeneratorAction::SetUsePhaseSpace,
+                              "Generar desde el espacio de fases abierto (false: GPS o tabla)");
+    fMessenger->DeclareMethod("recycle", &PrimaryGeneratorAction::SetRecycle,
+                              "Usos de cada evento del espacio de fases, rotado alrededor del eje (peso 1/N)");
+
+    // Haz de la matriz de respuesta (lo maneja /MedidorTR/matrix/run)
+    fMessenger->DeclareProperty("beam", fUseBeam,
+                                "Haz paralelo monoenergético sobre el cristal (matriz de respuesta)");
+    fMessenger->DeclarePropertyWithUnit("beamEnergy", "keV", fBeamEnergy,
+                                        "Energía del haz");
+    fMessenger->DeclareMethodWithUnit("beamAngle", "deg", &PrimaryGeneratorAction::SetBeamAngle,
+                                      "Ángulo del haz respecto del eje del detector");
 }
 
 // --- DESTRUCTOR ---
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
+    delete fMessenger;
     delete fParticleGun;
 }
 
+// --- CONFIGURACIÓN DEL SESGO ---
+void PrimaryGeneratorAction::SetBiasHalfAngle(G4double angle)
+{
+    if (angle <= 0. || angle >= 180.*deg) {
+        G4cerr << "ERROR: biasHalfAngle debe estar en (0, 180) grados" << G4endl;
+        return;
+    }
+    fBiasHalfAngle = angle;
+}
+
+void PrimaryGeneratorAction::SetBiasFraction(G4double fraction)
+{
+    // f = 1 dejaría sin muestrear las direcciones fuera del cono (que
+    // también pueden llegar al detector por dispersión): sería sesgado.
+    if (fraction <= 0. || fraction >= 1.) {
+        G4cerr << "ERROR: biasFraction debe estar en (0, 1)" << G4endl;
+        return;
+    }
+    fBiasFraction = fraction;
+}
+
+// --- FUENTE TABULADA ---
+void PrimaryGeneratorAction::LoadTable(G4String fileName)
+{
+    if (!fTable.Load(fileName)) return;
+    fUseTable = true;
+    if (fUseLines && !UpdateLines()) fUseLines = false;
+    if (G4Threading::G4GetThreadId() == 0) {
+        G4cout << ">>> Tabla de cascadas " << fileName << ": "
+               << fTable.GetNumberOfPatterns() << " patrones" << G4endl;
+    }
+}
+
+void PrimaryGeneratorAction::SetUseTable(G4bool useTable)
+{
+    if (useTable && !fTable.IsLoaded()) {
+        G4cerr << "ERROR: no hay tabla cargada. Use /MedidorTR/source/loadTable" << G4endl;
+        return;
+    }
+    fUseTable = useTable;
+}
+
+// --- MODO DE LÍNEAS ---
+void PrimaryGeneratorAction::AddLine(G4double energy)
+{
+    fLines.push_back(energy);
+    if (fUseLines) UpdateLines();
+}
+
+void PrimaryGeneratorAction::ClearLines()
+{
+    fLines.clear();
+    fUseLines = false;
+}
+
+void PrimaryGeneratorAction::SetContinuumFraction(G4double fraction)
+{
+    // f = 1 no emitiría nunca las líneas seleccionadas
+    if (fraction < 0. || fraction >= 1.) {
+        G4cerr << "ERROR: continuumFraction debe estar en [0, 1)" << G4endl;
+        return;
+    }
+    fContinuumFraction = fraction;
+    if (fUseLines) UpdateLines();
+}
+
+void PrimaryGeneratorAction::SetUseLines(G4bool useLines)
+{
+    if (!useLines) {
+        fUseLines = false;
+        return;
+    }
+    if (!fTable.IsLoaded() || fLines.empty()) {
+        G4cerr << "ERROR: el modo de líneas necesita /MedidorTR/source/loadTable y addLine" << G4endl;
+        return;
+    }
+    fUseLines = UpdateLines();
+    if (fUseLines) fUseTable = true;
+}
+
+// --- ESPACIO DE FASES ---
+void PrimaryGeneratorAction::LoadPhaseSpace(G4String fileName)
+{
+    if (!PhaseSpaceReader::Open(fileName, ++fPhaseSpaceLoads)) return;
+    fUsePhaseSpace = true;
+    fPhaseSpaceUses = 0;
+}
+
+void PrimaryGeneratorAction::SetUsePhaseSpace(G4bool usePhaseSpace)
+{
+    if (usePhaseSpace && !PhaseSpaceReader::IsOpen()) {
+        G4cerr << "ERROR: no hay espacio de fases abierto. Use /MedidorTR/source/phaseSpace" << G4endl;
+        return;
+    }
+    fUsePhaseSpace = usePhaseSpace;
+}
+
+void PrimaryGeneratorAction::SetRecycle(G4int recycle)
+{
+    if (recycle < 1) {
+        G4cerr << "ERROR: recycle debe ser >= 1" << G4endl;
+        return;
+    }
+    fRecycle = recycle;
+    fPhaseSpaceUses = 0;
+}
+
+// --- HAZ DE LA MATRIZ ---
+void PrimaryGeneratorAction::SetBeamAngle(G4double angle)
+{
+    if (angle < 0. || angle >= 90.*deg) {
+        G4cerr << "ERROR: beamAngle debe estar en [0, 90) grados" << G4endl;
+        return;
+    }
+    fBeamAngle = angle;
+}
+
+// Tolerancia de 0.5 keV: las energías de la tabla vienen de los datos de
+// Geant4 y pueden diferir en decimales de las del análisis
+G4bool PrimaryGeneratorAction::UpdateLines()
+{
+    const G4double tolerance = 0.5*keV;
+    if (!fTable.SelectLines(fLines, fContinuumFraction, tolerance)) return false;
+
+    if (G4Threading::G4GetThreadId() == 0) {
+        G4cout << ">>> Modo de líneas (continuo: " << fContinuumFraction << ")" << G4endl;
+        for (G4double energy : fLines) {
+            G4cout << "    " << energy/keV << " keV: "
+                   << fTable.GetLineIntensity(energy, tolerance) << " fotones/decaimiento" << G4endl;
+        }
+    }
+    return true;
+}
+
+// Un vértice en la posición que da el GPS (/gps/pos/...) y en t = 0: no
+// hace falta corregir el tiempo del decaimiento como con el ion.
+// Cascada completa: todos los fotones del patrón sorteado, peso 1.
+// Modo de líneas: un solo fotón, con el peso de su línea.
+G4PrimaryVertex* PrimaryGeneratorAction::GenerateFromTable(G4Event* event, G4double& weight)
+{
+    G4ThreeVector position = fParticleGun->GetCurrentSource()->GetPosDist()->GenerateOne();
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(position, 0.);
+
+    weight = 1.;
+    if (fUseLines) {
+        G4double energy;
+        weight = fTable.SampleLine(energy);
+
+        G4PrimaryParticle* gamma = new G4PrimaryParticle(G4Gamma::Definition());
+        gamma->SetKineticEnergy(energy);
+        gamma->SetMomentumDirection(G4RandomDirection());
+        vertex->SetPrimary(gamma);
+    } else {
+        for (G4double energy : fTable.Sample()) {
+            G4PrimaryParticle* gamma = new G4PrimaryParticle(G4Gamma::Definition());
+            gamma->SetKineticEnergy(energy);
+            gamma->SetMomentumDirection(G4RandomDirection());
+            vertex->SetPrimary(gamma);
+        }
+    }
+
+    event->AddPrimaryVertex(vertex);
+    return vertex;
+}
+
+// Un vértice por partícula registrada, en su posición sobre el plano y en
+// t = 0. El peso del evento original se aplica una vez por línea.
+void PrimaryGeneratorAction::GenerateFromPhaseSpace(G4Event* event)
+{
+    if (fPhaseSpaceUses == 0 || fPhaseSpaceUses >= fRecycle) {
+        if (!PhaseSpaceReader::NextEvent(fPhaseSpaceEvent)) {
+            // Archivo agotado: el evento no se procesa (ni se puntúa) y el
+            // run se detiene con un aborto suave (en MT lo hace el Master)
+            event->SetEventAborted();
+            if (G4Threading::IsWorkerThread()) {
+                G4MTRunManager::GetMasterRunManager()->AbortRun(true);
+            } else {
+                G4RunManager::GetRunManager()->AbortRun(true);
+            }
+            return;
+        }
+        fPhaseSpaceUses = 0;
+    }
+    fPhaseSpaceUses++;
+
+    // Rotación alrededor del eje de la línea (solo al reciclar)
+    G4double phi = (fRecycle > 1) ? twopi * G4UniformRand() : 0.;
+    G4double cosPhi = std::cos(phi), sinPhi = std::sin(phi);
+
+    G4int nBeamlines = fDetector->GetNumberOfBeamlines();
+    std::vector<G4bool> weighted(nBeamlines, false);
+    G4ParticleTable* particleTable = G4ParticleTable::GetParticleTable();
+    for (const PhaseSpaceRecord& record : fPhaseSpaceEvent) {
+        if (record.line >= nBeamlines) continue;
+        G4ParticleDefinition* particle = particleTable->FindParticle(record.pdg);
+        if (!particle) continue;
+
+        G4double x = record.x*mm, y = record.y*mm;
+        G4ThreeVector position(x*cosPhi - y*sinPhi + fDetector->GetBeamlineOffset(record.line),
+                               x*sinPhi + y*cosPhi, record.z*mm);
+        G4ThreeVector direction(record.u*cosPhi - record.v*sinPhi,
+                                record.u*sinPhi + record.v*cosPhi, record.w);
+
+        G4PrimaryParticle* primary = new G4PrimaryParticle(particle);
+        primary->SetKineticEnergy(record.energy*MeV);
+        primary->SetMomentumDirection(direction.unit());
+        G4PrimaryVertex* vertex = new G4PrimaryVertex(position, 0.);
+        vertex->SetPrimary(primary);
+        event->AddPrimaryVertex(vertex);
+
+        if (!weighted[record.line]) {
+            fEventAction->MultiplyWeight(record.weight / fRecycle, record.line);
+            weighted[record.line] = true;
+        }
+    }
+}
+
+// Dirección a fBeamAngle del eje Z con acimut al azar; el punto de partida
+// es uniforme en el disco de radio R perpendicular al haz, retrocedido
+// hasta fuera de la esfera de radio R que envuelve el cristal
+void PrimaryGeneratorAction::GenerateBeam(G4Event* event)
+{
+    G4double radius = fDetector->GetDetectorBoundingRadius();
+    G4ThreeVector center(fDetector->GetBeamlineOffset(0), 0., fDetector->GetDetectorZ());
+
+    G4double phi = twopi * G4UniformRand();
+    G4ThreeVector direction(std::sin(fBeamAngle)*std::cos(phi),
+                            std::sin(fBeamAngle)*std::sin(phi), std::cos(fBeamAngle));
+    G4ThreeVector e1 = direction.orthogonal().unit();
+    G4ThreeVector e2 = direction.cross(e1);
+
+    G4double r = radius * std::sqrt(G4UniformRand());
+    G4double psi = twopi * G4UniformRand();
+    G4ThreeVector position = center + r*std::cos(psi)*e1 + r*std::sin(psi)*e2
+                           - (radius + 1.*mm) * direction;
+
+    G4PrimaryParticle* gamma = new G4PrimaryParticle(G4Gamma::Definition());
+    gamma->SetKineticEnergy(fBeamEnergy);
+    gamma->SetMomentumDirection(direction);
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(position, 0.);
+    vertex->SetPrimary(gamma);
+    event->AddPrimaryVertex(vertex);
+}
+
+// --- DIRECCIÓN SESGADA ---
+// Isotrópica: P(cono) = (1 - cos(theta_max))/2. Mezcla: P(cono) = fBiasFraction.
+// Peso = P_isotrópica / P_mezcla, constante dentro y fuera del cono.
+G4double PrimaryGeneratorAction::SampleBiasedDirection(G4ThreeVector& direction) const
+{
+    G4double cosMax = std::cos(fBiasHalfAngle);
+    G4double coneFraction = 0.5 * (1. - cosMax);
+
+    G4double cosTheta, weight;
+    if (G4UniformRand() < fBiasFraction) {
+        cosTheta = cosMax + (1. - cosMax) * G4UniformRand();
+        weight = coneFraction / fBiasFraction;
+    } else {
+        cosTheta = -1. + (cosMax + 1.) * G4UniformRand();
+        weight = (1. - coneFraction) / (1. - fBiasFraction);
+    }
+
+    G4double sinTheta = std::sqrt(std::max(0., 1. - cosTheta*cosTheta));
+    G4double phi = twopi * G4UniformRand();
+    direction.set(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+    return weight;
+}
+
 // --- GENERATE PRIMARIES ---
 // Esta es la única función que realmente importa aquí
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
-    // Le decimos al GPS que dispare un vértice en este evento
-    fParticleGun->GeneratePrimaryVertex(anEvent);
-}
\ No newline at end of file
+    if (!fDetector) {
+        fDetector = static_cast<const DetectorConstruction*>
+            (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+    }
+
+    // Matriz de respuesta: solo el detector de la línea 0
+    if (fUseBeam) {
+        GenerateBeam(anEvent);
+        return;
+    }
+
+    // Espacio de fases: las partículas ya vienen con su dirección y peso
+    if (fUsePhaseSpace) {
+        GenerateFromPhaseSpace(anEvent);
+        return;
+    }
+
+    // Sesgo de gammas primarios: solo si se emiten isotrópicamente (tabla,
+    // o GPS con /gps/ang/type iso; con /gps/direction no tiene sentido).
+    // Los gammas del decaimiento del ion se sesgan en el StackingAction.
+    G4bool biasPrimaries = fBiasEnabled && (fUseTable ||
+        fParticleGun->GetCurrentSource()->GetAngDist()->GetDistType() == "iso");
+
+    // Multi-línea: un vértice por línea en cada evento. La posición de la
+    // macro (/gps/pos/centre) es relativa al eje de la línea y se desplaza
+    // en X; los absorbentes impiden que una fuente "vea" otra línea.
+    G4int nBeamlines = fDetector->GetNumberOfBeamlines();
+    for (G4int copy = 0; copy < nBeamlines; copy++) {
+        G4PrimaryVertex* vertex = nullptr;
+        if (fUseTable) {
+            G4double weight;
+            vertex = GenerateFromTable(anEvent, weight);
+            if (weight != 1.) fEventAction->MultiplyWeight(weight, copy);
+        } else {
+            // Le decimos al GPS que dispare un vértice en este evento
+            fParticleGun->GeneratePrimaryVertex(anEvent);
+            vertex = anEvent->GetPrimaryVertex(anEvent->GetNumberOfPrimaryVertex() - 1);
+        }
+
+        if (nBeamlines > 1) {
+            G4ThreeVector position = vertex->GetPosition();
+            vertex->SetPosition(position.x() + fDetector->GetBeamlineOffset(copy),
+                                position.y(), position.z());
+        }
+
+        if (biasPrimaries) {
+            for (G4PrimaryParticle* primary = vertex->GetPrimary(); primary; primary = primary->GetNext()) {
+                if (primary->GetParticleDefinition() != G4Gamma::Definition()) continue;
+                G4ThreeVector direction;
+                fEventAction->MultiplyWeight(SampleBiasedDirection(direction), copy);
+                primary->SetMomentumDirection(direction);
+            }
+        }
+    }
+}
@@ -0,0 +1,329 @@
+#include "ProgressMonitor.hh"
+#include "RoiCounter.hh"
+#include "RunCheckpoint.hh"
+
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Un contador por hilo, cada uno en su propia línea de caché para que
+    // los hilos no se estorben al sumar
+    struct alignas(64) Slot
+    {
+        std::atomic<G4long> events{0};
+        G4long lastEvents = 0; // Solo lo usa el reporte
+    };
+
+    // Registro global: configuración del run, contadores y ROIs publicadas
+    G4Mutex progressMutex = G4MUTEX_INITIALIZER;
+    G4bool  enabled = false;
+    std::unique_ptr<Slot[]> slots;
+    G4int   nSlots = 0;
+    std::atomic<G4long> generation(0); // Cada reporte pide ROIs nuevas
+    std::map<G4int, RoiCounter> published;
+
+    G4double interval = 0.;
+    G4String runFile, statusFile, format;
+    G4long   eventsBefore = 0; // Checkpoint: segmentos anteriores
+    G4long   eventsTarget = 0;
+    Clock::time_point startTime, lastTime;
+
+    // Hilo de reporte (lo arranca y lo detiene el Master)
+    std::thread reporter;
+    std::mutex  wakeMutex;
+    std::condition_variable wake;
+    G4bool stopRequested = false;
+
+    G4String FormatTime(G4double seconds)
+    {
+        G4long total = G4long(seconds + 0.5);
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%ldh %02ldm %02lds", total / 3600, (total / 60) % 60, total % 60);
+        return buffer;
+    }
+
+    // Reporte en pantalla y archivo de estado. roi = contadores fusionados
+    // (final del run) o nullptr para sumar las copias publicadas.
+    void Report(const RoiCounter* roi, G4bool finished)
+    {
+        Clock::time_point now = Clock::now();
+        G4double elapsed = std::chrono::duration<G4double>(now - startTime).count();
+        G4double dt = std::chrono::duration<G4double>(now - lastTime).count();
+        lastTime = now;
+
+        // Eventos/s de cada hilo en el último intervalo
+        std::vector<G4long> events(nSlots);
+        std::vector<G4double> rates(nSlots, 0.);
+        G4long total = 0;
+        for (G4int i = 0; i < nSlots; i++) {
+            events[i] = slots[i].events.load(std::memory_order_relaxed);
+            if (dt > 0.) rates[i] = (events[i] - slots[i].lastEvents) / dt;
+            slots[i].lastEvents = events[i];
+            total += events[i];
+        }
+        G4double rate = (elapsed > 0.) ? total / elapsed : 0.; // Promedio del run
+        G4long done = eventsBefore + total;
+        G4double eta = (rate > 0. && eventsTarget > done) ? (eventsTarget - done) / rate : 0.;
+
+        // Hilo más lento entre los que procesaron eventos en el intervalo
+        G4int slowest = -1;
+        G4double meanRate = 0.;
+        G4int active = 0;
+        for (G4int i = 0; i < nSlots; i++) {
+            if (rates[i] <= 0.) continue;
+            meanRate += rates[i];
+            active++;
+            if (slowest < 0 || rates[i] < rates[slowest]) slowest = i;
+        }
+        if (active > 0) meanRate /= active;
+
+        // ROIs: las fusionadas o la suma de las copias de cada hilo
+        std::unique_ptr<RoiCounter> sum;
+        if (!roi) {
+            G4AutoLock lock(&progressMutex);
+            if (!published.empty()) {
+                sum.reset(new RoiCounter(published.begin()->second));
+                for (auto it = std::next(published.begin()); it != published.end(); ++it) sum->Merge(it->second);
+            }
+            roi = sum.get();
+        }
+
+        std::ostringstream text;
+        text.setf(std::ios::fixed);
+        text.precision(0);
+        text << ">>> [Progreso] " << done;
+        if (eventsTarget > 0) {
+            text.precision(1);
+            text << " / " << eventsTarget << " eventos (" << 100. * done / eventsTarget << "%)";
+            text.precision(0);
+        } else {
+            text << " eventos";
+        }
+        text << " | " << rate << " eventos/s | " << FormatTime(elapsed);
+        if (finished) text << " | terminado";
+        else if (eta > 0.) text << " | ETA " << FormatTime(eta);
+        text << "\n";
+        if (!finished && nSlots > 1) {
+            text << "    Hilos (eventos/s):";
+            for (G4int i = 0; i < nSlots; i++) text << " " << rates[i];
+            if (slowest >= 0 && meanRate > 0.) {
+                text << " | más lento: hilo " << slowest << " ("
+                     << 100. * (rates[slowest] - meanRate) / meanRate << "%)";
+            }
+            text << "\n";
+        }
+        if (roi && roi->GetNumberOfROIs() > 0) {
+            text << "    ROIs:";
+            for (G4int copy = 0; copy < std::max(1, roi->GetNumberOfCopies()); copy++) {
+                for (std::size_t i = 0; i < roi->GetNumberOfROIs(); i++) {
+                    text.precision(1);
+                    text << " | L" << copy << " [" << roi->GetEmin(i)/keV << ", " << roi->GetEmax(i)/keV << "]: ";
+                    text.precision(0);
+                    text << roi->GetSumW(copy, i);
+                }
+            }
+            text << "\n";
+        }
+        G4cout << text.str() << std::flush;
+
+        if (statusFile.empty()) return;
+
+        // Archivo de estado: se escribe aparte y se renombra, para que quien
+        // lo lea nunca vea uno a medias
+        G4String tmpName = statusFile + ".tmp";
+        {
+            std::ofstream file(tmpName);
+            file.precision(10);
+            if (format == "prometheus") {
+                G4String label = "{archivo=\"" + runFile + "\"}";
+                file << "# HELP medidortr_eventos Eventos procesados\n"
+                     << "# TYPE medidortr_eventos gauge\n"
+                     << "medidortr_eventos" << label << " " << done << "\n"
+                     << "medidortr_eventos_objetivo" << label << " " << eventsTarget << "\n"
+                     << "medidortr_eventos_por_segundo" << label << " " << rate << "\n"
+                     << "medidortr_eta_segundos" << label << " " << eta << "\n"
+                     << "medidortr_terminado" << label << " " << (finished ? 1 : 0) << "\n";
+                for (G4int i = 0; i < nSlots; i++) {
+                    file << "medidortr_hilo_eventos_por_segundo{archivo=\"" << runFile << "\",hilo=\""
+                         << i << "\"} " << rates[i] << "\n";
+                }
+                if (roi) {
+                    for (G4int copy = 0; copy < roi->GetNumberOfCopies(); copy++) {
+                        for (std::size_t i = 0; i < roi->GetNumberOfROIs(); i++) {
+                            file << "medidortr_roi_cuentas{archivo=\"" << runFile << "\",linea=\"" << copy
+                                 << "\",emin_kev=\"" << roi->GetEmin(i)/keV << "\",emax_kev=\""
+                                 << roi->GetEmax(i)/keV << "\"} " << roi->GetSumW(copy, i) << "\n";
+                        }
+                    }
+                }
+            } else {
+                file << "{\n  \"archivo\": \"" << runFile << "\",\n"
+                     << "  \"estado\": \"" << (finished ? "terminado" : "corriendo") << "\",\n"
+                     << "  \"eventos\": " << done << ",\n"
+                     << "  \"objetivo\": " << eventsTarget << ",\n"
+                     << "  \"eventos_s\": " << rate << ",\n"
+                     << "  \"transcurrido_s\": " << elapsed << ",\n"
+                     << "  \"eta_s\": " << eta << ",\n"
+                     << "  \"hilos\": [";
+                for (G4int i = 0; i < nSlots; i++) {
+                    file << (i ? ", " : "") << "{\"hilo\": " << i << ", \"eventos\": " << events[i]
+                         << ", \"eventos_s\": " << rates[i] << "}";
+                }
+                file << "],\n  \"rois\": [";
+                G4bool first = true;
+                if (roi) {
+                    for (G4int copy = 0; copy < roi->GetNumberOfCopies(); copy++) {
+                        for (std::size_t i = 0; i < roi->GetNumberOfROIs(); i++) {
+                            file << (first ? "" : ", ") << "{\"linea\": " << copy
+                                 << ", \"emin_keV\": " << roi->GetEmin(i)/keV
+                                 << ", \"emax_keV\": " << roi->GetEmax(i)/keV
+                                 << ", \"cuentas\": " << roi->GetSumW(copy, i) << "}";
+                            first = false;
+                        }
+                    }
+                }
+                file << "]\n}\n";
+            }
+        }
+        std::rename(tmpName.c_str(), statusFile.c_str());
+    }
+
+    void ReporterLoop()
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        auto period = std::chrono::duration<G4double>(interval);
+        while (!wake.wait_for(lock, period, [] { return stopRequested; })) {
+            lock.unlock();
+            // Los hilos publican sus ROIs en su próximo evento; este reporte
+            // usa las del pedido anterior (a lo sumo un intervalo de atraso)
+            generation++;
+            Report(nullptr, false);
+            lock.lock();
+        }
+    }
+}
+
+// 1. CONSTRUCTOR
+ProgressMonitor::ProgressMonitor()
+: fMessenger(nullptr),
+  fInterval(60.),
+  fFormat("json"),
+  fEvents(nullptr),
+  fGeneration(0)
+{
+    if (!G4Threading::IsMasterThread()) return;
+
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/progress/", "Progreso del run en vivo");
+    fMessenger->DeclareProperty("interval", fInterval,
+                                "Segundos entre reportes de eventos/s, ETA y ROIs (0 = desactivado)")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareProperty("statusFile", fStatusFile,
+                                "Archivo de estado que se reescribe en cada reporte (vacío = ninguno)")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareProperty("format", fFormat,
+                                "Formato del archivo de estado: json o prometheus (textfile)")
+        .SetCandidates("json prometheus")
+        .SetToBeBroadcasted(false);
+}
+
+// 2. DESTRUCTOR
+ProgressMonitor::~ProgressMonitor()
+{
+    delete fMessenger;
+}
+
+// 3. INICIO DEL RUN
+// El Master empieza antes que los workers: prepara los contadores y
+// arranca el hilo de reporte; cada worker toma después su contador
+void ProgressMonitor::BeginOfRun(const G4Run* run, const G4String& fileName)
+{
+    fEvents = nullptr;
+
+    if (!G4Threading::IsMasterThread()) {
+        G4AutoLock lock(&progressMutex);
+        if (!enabled) return;
+        G4int thread = std::max(0, G4Threading::G4GetThreadId());
+        fEvents = &slots[thread % nSlots].events;
+        fGeneration = generation.load();
+        return;
+    }
+
+    G4AutoLock lock(&progressMutex);
+    enabled = (fInterval > 0.);
+    published.clear();
+    if (!enabled) return;
+
+    nSlots = std::max(1, G4RunManager::GetRunManager()->GetNumberOfThreads());
+    slots.reset(new Slot[nSlots]);
+    interval = fInterval;
+    statusFile = fStatusFile;
+    format = fFormat;
+    runFile = fileName;
+    eventsBefore = RunCheckpoint::GetEventsBefore();
+    eventsTarget = RunCheckpoint::IsActive() ? RunCheckpoint::GetTargetEvents()
+                                             : run->GetNumberOfEventToBeProcessed();
+    startTime = lastTime = Clock::now();
+    generation = 0;
+    lock.unlock();
+
+    // Secuencial: el Master también procesa los eventos
+    if (!G4Threading::IsMultithreadedApplication()) fEvents = &slots[0].events;
+    fGeneration = 0;
+
+    stopRequested = false;
+    reporter = std::thread(ReporterLoop);
+}
+
+// 4. CONTEO (hilo que procesa eventos)
+// Un incremento atómico por evento; la copia de las ROIs solo cuando el
+// reporte la pidió
+void ProgressMonitor::EndOfEvent(const RoiCounter& roi)
+{
+    if (!fEvents) return;
+    fEvents->fetch_add(1, std::memory_order_relaxed);
+
+    G4long current = generation.load(std::memory_order_relaxed);
+    if (current == fGeneration) return;
+    fGeneration = current;
+    if (roi.GetNumberOfROIs() == 0) return;
+
+    G4int thread = G4Threading::G4GetThreadId();
+    G4AutoLock lock(&progressMutex);
+    published.erase(thread);
+    published.emplace(thread, roi);
+}
+
+// 5. FIN DEL RUN (Master, con las ROIs ya fusionadas)
+void ProgressMonitor::EndOfRun(const RoiCounter& roi)
+{
+    fEvents = nullptr;
+    if (!G4Threading::IsMasterThread() || !reporter.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopRequested = true;
+    }
+    wake.notify_all();
+    reporter.join();
+
+    Report(&roi, true);
+}
@@ -0,0 +1,449 @@
+#include "ResponseMatrix.hh"
+#include "DetectorResponse.hh"
+#include "DetectorConstruction.hh"
+#include "PhaseSpace.hh"
+
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4AccumulableManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Timer.hh"
+#include "G4ThreeVector.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+// 1. CONSTRUCTOR
+ResponseMatrix::ResponseMatrix(const DetectorResponse& response)
+: fMessenger(nullptr),
+  fResponse(response),
+  fCounter("ResponseMatrix"),
+  fRecording(false),
+  fAngleBins(6),
+  fMaxAngle(60.*deg),
+  fEvents(1000000),
+  fBins(1600),
+  fEmax(1600.*keV),
+  fFileName("Matriz_LaBr3.txt"),
+  fMatrixEmax(0.),
+  fRadius(0.),
+  fDetectorZ(0.)
+{
+    G4AccumulableManager::Instance()->RegisterAccumulable(&fCounter);
+    fCounter.SetBinning(fBins, fEmax);
+
+    // 20 keV - 1.6 MeV: rayos X del Eu/Sm hasta la línea de 1408 keV
+    AddEnergyRange(20., 1600., 50);
+
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/matrix/", "Matriz de respuesta del detector");
+
+    // Binning y registro: los workers llenan el espectro, se reenvían
+    fMessenger->DeclareMethod("setBinning", &ResponseMatrix::SetBinning,
+                              "Bins de energía depositada: <bins> <Emax en keV>");
+    fMessenger->DeclareProperty("record", fRecording,
+                                "Llenar el espectro de la matriz (lo maneja /MedidorTR/matrix/run)");
+
+    // Grilla, generación y plegado: solo en el Master
+    fMessenger->DeclareMethod("addEnergy", &ResponseMatrix::AddEnergy,
+                              "Agregar una energía incidente en keV")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("addEnergyRange", &ResponseMatrix::AddEnergyRange,
+                              "Energías con paso logarítmico: <Emin> <Emax> <puntos> en keV")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("clearEnergies", &ResponseMatrix::ClearEnergies,
+                              "Borrar la lista de energías")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareProperty("angleBins", fAngleBins,
+                                "Bins de ángulo de incidencia (uniformes en cos theta)")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclarePropertyWithUnit("maxAngle", "deg", fMaxAngle,
+                                        "Ángulo máximo respecto del eje del detector")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareProperty("events", fEvents,
+                                "Fotones por bin de energía y ángulo")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareProperty("fileName", fFileName,
+                                "Archivo de la matriz")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("run", &ResponseMatrix::Run,
+                              "Simular todos los bins y guardar la matriz")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_Idle);
+    fMessenger->DeclareMethod("load", &ResponseMatrix::Load,
+                              "Cargar una matriz guardada")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("foldPhaseSpace", &ResponseMatrix::FoldPhaseSpace,
+                              "Plegar los fotones de una línea de un espacio de fases: <archivo.phsp> [línea, 0]"
+                              " -> <base>_plegado.csv (<base>_<línea>_plegado.csv si hay varias). Cada fotón"
+                              " se pliega solo: no hay suma de coincidencias de la cascada")
+        .SetParameterName(1, "line", true)
+        .SetDefaultValue(1, "0")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("foldLines", &ResponseMatrix::FoldLines,
+                              "Plegar un espectro incidente (líneas <E_keV> <fotones> [cos_theta]) -> <base>_plegado.csv."
+                              " Cada fotón se pliega solo: no hay suma de coincidencias de la cascada")
+        .SetToBeBroadcasted(false);
+}
+
+// 2. DESTRUCTOR
+ResponseMatrix::~ResponseMatrix()
+{
+    delete fMessenger;
+}
+
+// 3. CONFIGURACIÓN
+void ResponseMatrix::AddEnergy(G4double energyKeV)
+{
+    if (energyKeV <= 0.) {
+        G4cerr << "ERROR: energía inválida " << energyKeV << " keV" << G4endl;
+        return;
+    }
+    fEnergies.push_back(energyKeV*keV);
+}
+
+void ResponseMatrix::AddEnergyRange(G4double eMinKeV, G4double eMaxKeV, G4int points)
+{
+    if (eMinKeV <= 0. || eMaxKeV <= eMinKeV || points < 2) {
+        G4cerr << "ERROR: rango de energías inválido" << G4endl;
+        return;
+    }
+    for (G4int i = 0; i < points; i++) {
+        AddEnergy(eMinKeV * std::pow(eMaxKeV / eMinKeV, G4double(i) / (points - 1)));
+    }
+}
+
+void ResponseMatrix::ClearEnergies()
+{
+    fEnergies.clear();
+}
+
+void ResponseMatrix::SetBinning(G4int bins, G4double eMaxKeV)
+{
+    if (bins < 1 || eMaxKeV <= 0.) {
+        G4cerr << "ERROR: binning inválido" << G4endl;
+        return;
+    }
+    fBins = bins;
+    fEmax = eMaxKeV*keV;
+    fCounter.SetBinning(fBins, fEmax);
+}
+
+// 4. GENERACIÓN
+void ResponseMatrix::Run()
+{
+    if (fEnergies.empty() || fAngleBins < 1 || fEvents < 1) {
+        G4cerr << "ERROR: matriz vacía. Use /MedidorTR/matrix/addEnergy, angleBins y events" << G4endl;
+        return;
+    }
+
+    G4RunManager* runManager = G4RunManager::GetRunManager();
+    G4UImanager* UImanager = G4UImanager::GetUIpointer();
+    auto detector = static_cast<const DetectorConstruction*>(runManager->GetUserDetectorConstruction());
+    if (detector->GetNumberOfBeamlines() > 1) {
+        G4cout << "NOTA: la matriz usa solo el detector de la línea 0" << G4endl;
+    }
+    fRadius = detector->GetDetectorBoundingRadius();
+    fDetectorZ = detector->GetDetectorZ();
+    fMatrixEmax = fEmax;
+
+    std::sort(fEnergies.begin(), fEnergies.end());
+    fEnergies.erase(std::unique(fEnergies.begin(), fEnergies.end()), fEnergies.end());
+
+    G4double cosMin = std::cos(fMaxAngle);
+    fCosTheta.clear();
+    for (G4int j = 0; j < fAngleBins; j++) {
+        fCosTheta.push_back(1. - (j + 0.5) * (1. - cosMin) / fAngleBins);
+    }
+
+    G4cout << "=== MATRIZ DE RESPUESTA: " << fEnergies.size() << " energías x "
+           << fAngleBins << " ángulos x " << fEvents << " fotones ===" << G4endl;
+    G4Timer timer;
+    timer.Start();
+
+    // Cada bin es un run: el índice dual-energy no tiene sentido aquí.
+    // Se guarda su estado para devolverlo al final (los runs siguientes
+    // de la sesión lo siguen usando).
+    G4String indexEnabled = UImanager->GetCurrentValues("/MedidorTR/index/enable");
+    UImanager->ApplyCommand("/MedidorTR/index/enable false");
+    UImanager->ApplyCommand("/MedidorTR/source/beam true");
+    UImanager->ApplyCommand("/MedidorTR/matrix/record true");
+
+    fRows.assign(fEnergies.size(), std::vector<std::vector<G4double>>(fAngleBins));
+    for (std::size_t i = 0; i < fEnergies.size(); i++) {
+        UImanager->ApplyCommand("/MedidorTR/source/beamEnergy " + std::to_string(fEnergies[i]/keV) + " keV");
+        for (G4int j = 0; j < fAngleBins; j++) {
+            UImanager->ApplyCommand("/MedidorTR/source/beamAngle " + std::to_string(std::acos(fCosTheta[j])/deg) + " deg");
+            runManager->BeamOn(fEvents);
+
+            // En el Master, el espectro ya es la suma de todos los hilos
+            std::vector<G4double>& row = fRows[i][j];
+            row.resize(fCounter.GetBins());
+            for (G4int bin = 0; bin < fCounter.GetBins(); bin++) row[bin] = fCounter.GetSumW(bin) / fEvents;
+        }
+        G4cout << ">>> Matriz: " << fEnergies[i]/keV << " keV listo" << G4endl;
+    }
+
+    UImanager->ApplyCommand("/MedidorTR/matrix/record false");
+    UImanager->ApplyCommand("/MedidorTR/source/beam false");
+    if (!indexEnabled.empty()) UImanager->ApplyCommand("/MedidorTR/index/enable " + indexEnabled);
+
+    timer.Stop();
+    if (Save()) {
+        G4cout << "=== MATRIZ -> " << fFileName << " (" << timer.GetRealElapsed() << " s) ===" << G4endl;
+    }
+}
+
+G4bool ResponseMatrix::Save() const
+{
+    std::ofstream file(fFileName);
+    if (!file.good()) {
+        G4cerr << "ERROR: no se pudo escribir " << fFileName << G4endl;
+        return false;
+    }
+    file << "# Matriz de respuesta LaBr3(Ce): probabilidad por fotón incidente en el disco\n";
+    file << "# bins " << fRows[0][0].size() << " emax_keV " << fMatrixEmax/keV
+         << " radio_cm " << fRadius/cm << " detectorZ_cm " << fDetectorZ/cm << "\n";
+    for (std::size_t i = 0; i < fEnergies.size(); i++) {
+        for (std::size_t j = 0; j < fCosTheta.size(); j++) {
+            file << fEnergies[i]/keV << " " << fCosTheta[j] << " " << fEvents;
+            for (G4double value : fRows[i][j]) file << " " << value;
+            file << "\n";
+        }
+    }
+    return true;
+}
+
+// 5. LECTURA
+G4bool ResponseMatrix::Load(G4String fileName)
+{
+    std::ifstream file(fileName);
+    if (!file.good()) {
+        G4cerr << "ERROR: no se pudo abrir la matriz " << fileName << G4endl;
+        return false;
+    }
+
+    // Energía -> cos theta -> fila (ordenadas por el map)
+    std::map<G4double, std::map<G4double, std::vector<G4double>>> rows;
+    G4int bins = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        if (line.empty()) continue;
+        if (line[0] == '#') {
+            std::string hash, key;
+            fields >> hash >> key;
+            if (key == "bins") {
+                std::string label;
+                G4double eMax, radius, detectorZ;
+                fields >> bins >> label >> eMax >> label >> radius >> label >> detectorZ;
+                fMatrixEmax = eMax*keV;
+                fRadius = radius*cm;
+                fDetectorZ = detectorZ*cm;
+            }
+            continue;
+        }
+        G4double energy, cosTheta, events;
+        if (!(fields >> energy >> cosTheta >> events)) continue;
+        std::vector<G4double>& row = rows[energy*keV][cosTheta];
+        row.reserve(bins);
+        G4double value;
+        while (fields >> value) row.push_back(value);
+    }
+    if (rows.empty() || bins < 1) {
+        G4cerr << "ERROR: matriz vacía: " << fileName << G4endl;
+        return false;
+    }
+
+    fEnergies.clear();
+    fCosTheta.clear();
+    fRows.clear();
+    for (auto& energy : rows) {
+        fEnergies.push_back(energy.first);
+        fRows.emplace_back();
+        // Mismo orden que al generar: cos theta decreciente
+        for (auto angle = energy.second.rbegin(); angle != energy.second.rend(); ++angle) {
+            if (fEnergies.size() == 1) fCosTheta.push_back(angle->first);
+            angle->second.resize(bins, 0.);
+            fRows.back().push_back(angle->second);
+        }
+    }
+    G4cout << ">>> Matriz " << fileName << ": " << fEnergies.size() << " energías x "
+           << fCosTheta.size() << " ángulos x " << bins << " bins" << G4endl;
+    return true;
+}
+
+// 6. PLEGADO
+// Interpolación lineal entre las dos energías vecinas de la matriz. El
+// fotopico de cada fila (bin de su energía) se mueve a la energía pedida;
+// el continuo por encima de ella no existe y se descarta.
+void ResponseMatrix::AddIncident(G4double energy, G4double cosTheta, G4double weight,
+                                 std::vector<G4double>& spectrum) const
+{
+    G4int bins = G4int(spectrum.size());
+    G4int peakBin = G4int(energy / fMatrixEmax * bins);
+    if (peakBin >= bins || energy <= 0.) return;
+
+    // Bin de ángulo más cercano
+    std::size_t angle = 0;
+    for (std::size_t j = 1; j < fCosTheta.size(); j++) {
+        if (std::abs(cosTheta - fCosTheta[j]) < std::abs(cosTheta - fCosTheta[angle])) angle = j;
+    }
+
+    // Energías vecinas (fuera de la grilla: la fila del extremo)
+    std::size_t upper = std::upper_bound(fEnergies.begin(), fEnergies.end(), energy) - fEnergies.begin();
+    std::size_t lower = (upper == 0) ? 0 : upper - 1;
+    if (upper >= fEnergies.size()) upper = fEnergies.size() - 1;
+    G4double t = (upper == lower) ? 0. : (energy - fEnergies[lower]) / (fEnergies[upper] - fEnergies[lower]);
+    t = std::min(1., std::max(0., t));
+
+    const std::size_t rows[2] = {lower, upper};
+    const G4double coefficients[2] = {1. - t, t};
+    for (G4int r = 0; r < 2; r++) {
+        if (coefficients[r] <= 0.) continue;
+        const std::vector<G4double>& row = fRows[rows[r]][angle];
+        G4int rowPeak = G4int(fEnergies[rows[r]] / fMatrixEmax * bins);
+        G4double w = weight * coefficients[r];
+        for (G4int bin = 0; bin < std::min(peakBin, rowPeak); bin++) spectrum[bin] += w * row[bin];
+        if (rowPeak < bins) spectrum[peakBin] += w * row[rowPeak];
+    }
+}
+
+void ResponseMatrix::FoldPhaseSpace(G4String fileName, G4int line)
+{
+    if (fRows.empty()) {
+        G4cerr << "ERROR: no hay matriz. Use /MedidorTR/matrix/load o run" << G4endl;
+        return;
+    }
+    G4Timer timer;
+    timer.Start();
+
+    PhaseSpaceHeader header;
+    std::vector<PhaseSpaceRecord> records;
+    if (!PhaseSpaceReader::ReadFile(fileName, header, records)) return;
+
+    // Un espectro por línea: cada línea tiene su propio detector (X de los
+    // registros relativo a su eje) y su concentración
+    std::vector<G4bool> present;
+    for (const PhaseSpaceRecord& record : records) {
+        if (record.line >= G4int(present.size())) present.resize(record.line + 1, false);
+        present[record.line] = true;
+    }
+    if (line < 0 || line >= G4int(present.size()) || !present[line]) {
+        G4cerr << "ERROR: " << fileName << " no tiene registros de la línea " << line << G4endl;
+        return;
+    }
+    G4bool multiLine = std::count(present.begin(), present.end(), true) > 1;
+
+    // Solo fotones cuya recta pasa por el disco del cristal (misma
+    // definición que el haz de la generación). Normalizado por evento.
+    std::vector<G4double> spectrum(fRows[0][0].size(), 0.);
+    G4ThreeVector center(0., 0., fDetectorZ);
+    G4long used = 0;
+    for (const PhaseSpaceRecord& record : records) {
+        if (record.pdg != 22 || record.line != line) continue;
+        G4ThreeVector position(record.x*mm, record.y*mm, record.z*mm);
+        G4ThreeVector direction = G4ThreeVector(record.u, record.v, record.w).unit();
+        G4ThreeVector toCenter = center - position;
+        if (toCenter.dot(direction) <= 0.) continue;
+        if (toCenter.cross(direction).mag() >= fRadius) continue;
+
+        AddIncident(record.energy*MeV, direction.z(), record.weight / header.sourceEvents, spectrum);
+        used++;
+    }
+
+    G4String base = fileName;
+    if (base.size() > 5 && base.substr(base.size() - 5) == ".phsp") base = base.substr(0, base.size() - 5);
+    if (multiLine) base += "_" + std::to_string(line);
+    WriteSpectrum(spectrum, base + "_plegado.csv");
+
+    timer.Stop();
+    G4cout << ">>> Plegado " << fileName << " (línea " << line << "): " << used
+           << " fotones hacia el cristal de " << records.size() << " registros ("
+           << timer.GetRealElapsed() << " s)" << G4endl;
+}
+
+void ResponseMatrix::FoldLines(G4String fileName)
+{
+    if (fRows.empty()) {
+        G4cerr << "ERROR: no hay matriz. Use /MedidorTR/matrix/load o run" << G4endl;
+        return;
+    }
+    std::ifstream file(fileName);
+    if (!file.good()) {
+        G4cerr << "ERROR: no se pudo abrir " << fileName << G4endl;
+        return;
+    }
+    G4Timer timer;
+    timer.Start();
+
+    // Fotones que llegan al disco del cristal; sin ángulo, incidencia normal
+    std::vector<G4double> spectrum(fRows[0][0].size(), 0.);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+        G4double energy, photons, cosTheta = 1.;
+        if (!(fields >> energy >> photons)) continue;
+        fields >> cosTheta;
+        AddIncident(energy*keV, cosTheta, photons, spectrum);
+    }
+
+    G4String base = fileName;
+    std::size_t dot = base.rfind('.');
+    if (dot != std::string::npos) base = base.substr(0, dot);
+    WriteSpectrum(spectrum, base + "_plegado.csv");
+
+    timer.Stop();
+    G4cout << ">>> Plegado " << fileName << " (" << timer.GetRealElapsed() << " s)" << G4endl;
+}
+
+// Resolución gaussiana (integral exacta por bin) y canales del MCA, con
+// los mismos parámetros que usa el bucle de eventos
+void ResponseMatrix::WriteSpectrum(const std::vector<G4double>& spectrum, const G4String& fileName) const
+{
+    G4int bins = G4int(spectrum.size());
+    G4double width = fMatrixEmax / bins;
+
+    std::vector<G4double> measured(spectrum);
+    if (fResponse.IsEnabled()) {
+        std::fill(measured.begin(), measured.end(), 0.);
+        for (G4int bin = 0; bin < bins; bin++) {
+            if (spectrum[bin] == 0.) continue;
+            G4double energy = (bin + 0.5) * width;
+            G4double sigma = fResponse.GetFWHM(energy) / 2.355;
+            if (sigma <= 0.) { measured[bin] += spectrum[bin]; continue; }
+            G4int first = std::max(0, G4int((energy - 5.*sigma) / width));
+            G4int last = std::min(bins - 1, G4int((energy + 5.*sigma) / width));
+            for (G4int k = first; k <= last; k++) {
+                G4double lo = (k * width - energy) / (std::sqrt(2.) * sigma);
+                G4double hi = ((k + 1) * width - energy) / (std::sqrt(2.) * sigma);
+                measured[k] += spectrum[bin] * 0.5 * (std::erf(hi) - std::erf(lo));
+            }
+        }
+    }
+
+    // Canales del MCA: cada bin va al canal que contiene su centro
+    G4int channels = fResponse.GetChannels();
+    G4double channelWidth = width;
+    if (channels > 0) {
+        channelWidth = fResponse.GetChannelEmax() / channels;
+        std::vector<G4double> mca(channels, 0.);
+        for (G4int bin = 0; bin < bins; bin++) {
+            G4int channel = G4int((bin + 0.5) * width / channelWidth);
+            if (channel < channels) mca[channel] += measured[bin];
+        }
+        measured.swap(mca);
+    }
+
+    std::ofstream file(fileName);
+    file << "E_keV,cuentas\n";
+    for (std::size_t i = 0; i < measured.size(); i++) {
+        file << (i + 0.5) * channelWidth / keV << "," << measured[i] << "\n";
+    }
+    G4cout << ">>> Espectro plegado -> " << fileName << G4endl;
+}
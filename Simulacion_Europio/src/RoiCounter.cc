@@ -0,0 +1,98 @@
+#include "RoiCounter.hh"
+
+RoiCounter::RoiCounter(const G4String& name)
+: G4VAccumulable(name)
+{}
+
+RoiCounter::~RoiCounter()
+{}
+
+void RoiCounter::AddROI(G4double eMin, G4double eMax)
+{
+    fEmin.push_back(eMin);
+    fEmax.push_back(eMax);
+    Reset();
+}
+
+void RoiCounter::Clear()
+{
+    fEmin.clear();
+    fEmax.clear();
+    Reset();
+}
+
+G4int RoiCounter::GetNumberOfCopies() const
+{
+    return fEmin.empty() ? 0 : G4int(fSumW.size() / fEmin.size());
+}
+
+void RoiCounter::Fill(G4int copy, G4double edep, G4double weight)
+{
+    std::size_t nROI = fEmin.size();
+    if (nROI == 0) return;
+
+    std::size_t first = copy * nROI;
+    if (first + nROI > fSumW.size()) {
+        fSumW.resize(first + nROI, 0.);
+        fSumW2.resize(first + nROI, 0.);
+    }
+    for (std::size_t roi = 0; roi < nROI; roi++) {
+        if (edep >= fEmin[roi] && edep < fEmax[roi]) {
+            fSumW[first + roi] += weight;
+            fSumW2[first + roi] += weight * weight;
+        }
+    }
+}
+
+G4double RoiCounter::GetSumW(G4int copy, std::size_t roi) const
+{
+    std::size_t i = copy * fEmin.size() + roi;
+    return i < fSumW.size() ? fSumW[i] : 0.;
+}
+
+G4double RoiCounter::GetSumW2(G4int copy, std::size_t roi) const
+{
+    std::size_t i = copy * fEmin.size() + roi;
+    return i < fSumW2.size() ? fSumW2[i] : 0.;
+}
+
+void RoiCounter::Write(std::ostream& out) const
+{
+    out << fEmin.size() << " " << fSumW.size();
+    for (std::size_t i = 0; i < fSumW.size(); i++) out << " " << fSumW[i] << " " << fSumW2[i];
+    out << "\n";
+}
+
+G4bool RoiCounter::Read(std::istream& in)
+{
+    std::size_t nROI = 0, size = 0;
+    in >> nROI >> size;
+    std::vector<G4double> sumW(size), sumW2(size);
+    for (std::size_t i = 0; i < size; i++) in >> sumW[i] >> sumW2[i];
+    if (!in || nROI != fEmin.size()) return false;
+
+    fSumW = sumW;
+    fSumW2 = sumW2;
+    return true;
+}
+
+// Los hilos tienen las mismas ROIs (los comandos se reenvían a todos);
+// solo puede variar cuántas copias vio cada uno
+void RoiCounter::Merge(const G4VAccumulable& other)
+{
+    const RoiCounter& otherCounter = static_cast<const RoiCounter&>(other);
+    if (otherCounter.fSumW.size() > fSumW.size()) {
+        fSumW.resize(otherCounter.fSumW.size(), 0.);
+        fSumW2.resize(otherCounter.fSumW2.size(), 0.);
+    }
+    for (std::size_t i = 0; i < otherCounter.fSumW.size(); i++) {
+        fSumW[i] += otherCounter.fSumW[i];
+        fSumW2[i] += otherCounter.fSumW2[i];
+    }
+}
+
+void RoiCounter::Reset()
+{
+    fSumW.clear();
+    fSumW2.clear();
+}
@@ -1,45 +1,473 @@
 #include "RunAction.hh"
+#include "DetectorConstruction.hh"
+#include "G4RunManager.hh"
 #include "G4Run.hh"
 #include "G4AnalysisManager.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4Threading.hh" 
+#include "G4GenericMessenger.hh"
+#include "CascadeTable.hh"
+#include "PhaseSpace.hh"
+#include "RunCheckpoint.hh"
+#include "SteppingAction.hh"
+#include "TrackingAction.hh"
+#include "G4AccumulableManager.hh"
+#include "G4Material.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
 
 RunAction::RunAction()
-: G4UserRunAction()
+: G4UserRunAction(),
+  fMessenger(nullptr),
+  fOutputMessenger(nullptr),
+  fHistoOutput(true),
+  fNtupleOutput(false),
+  fHistoBins(1600),
+  fHistoEmax(1600.*keV),
+  fMatrix(fResponse),
+  fROIMessenger(nullptr),
+  fROI("ROI"),
+  fSteppingAction(nullptr),
+  fTrackingAction(nullptr),
+  fProfilerAttached(false),
+  fKilledNeutrinos("KilledNeutrinos", 0),
+  fKilledIons("KilledIons", 0),
+  fKilledCharged("KilledCharged", 0)
 {
     auto analysisManager = G4AnalysisManager::Instance();
     analysisManager->SetDefaultFileType("root");
     analysisManager->SetVerboseLevel(1);
     analysisManager->SetNtupleMerging(true);
+    analysisManager->SetActivation(true); // Las NTuples se apagan con /MedidorTR/output/ntuple false
     
     if (G4Threading::IsMasterThread()) {
         G4cout << ">>> [Master] RunAction iniciado. Merging activado." << G4endl;
+
+        // El registro se comparte entre hilos: el comando vive solo en el Master
+        fMessenger = new G4GenericMessenger(this, "/MedidorTR/table/", "Tabla de cascadas Eu-152");
+        fMessenger->DeclareMethod("record", &RunAction::RecordCascadeTable,
+                                  "Registrar los fotones del decaimiento en el próximo run: <archivo> [decaimientos por línea, 0 = todo el run]")
+            .SetParameterName(1, "decays", true)
+            .SetDefaultValue(1, "0")
+            .SetToBeBroadcasted(false)
+            .SetStates(G4State_Idle);
     }
+
+    // Tipo de salida: el Master y los workers deben tener los mismos bins
+    // para fusionar los histogramas (los comandos se reenvían a los hilos)
+    fOutputMessenger = new G4GenericMessenger(this, "/MedidorTR/output/", "Salida de la simulación");
+    fOutputMessenger->DeclareProperty("histo", fHistoOutput,
+                                      "Llenar el histograma Energy (tamaño fijo, no crece con los eventos)");
+    fOutputMessenger->DeclareProperty("ntuple", fNtupleOutput,
+                                      "Llenar la NTuple Scoring (una fila por evento con depósito)");
+    fOutputMessenger->DeclareProperty("histoBins", fHistoBins,
+                                      "Número de bins del histograma Energy");
+    fOutputMessenger->DeclarePropertyWithUnit("histoEmax", "keV", fHistoEmax,
+                                              "Energía máxima del histograma Energy");
+
+    // ROIs: los workers las llenan y el Master las fusiona
+    G4AccumulableManager::Instance()->RegisterAccumulable(&fROI);
+    G4AccumulableManager::Instance()->RegisterAccumulable(fKilledNeutrinos);
+    G4AccumulableManager::Instance()->RegisterAccumulable(fKilledIons);
+    G4AccumulableManager::Instance()->RegisterAccumulable(fKilledCharged);
+    fROIMessenger = new G4GenericMessenger(this, "/MedidorTR/roi/", "Regiones de interés en energía");
+    fROIMessenger->DeclareMethod("add", &RunAction::AddROI,
+                                 "Agregar una ROI: <Emin> <Emax> en keV (ej. 116 128)");
+    fROIMessenger->DeclareMethod("clear", &RunAction::ClearROIs,
+                                 "Borrar todas las ROIs");
 }
 
 RunAction::~RunAction()
-{}
+{
+    delete fROIMessenger;
+    delete fOutputMessenger;
+    delete fMessenger;
+
+    // Registrados, son del G4RunManager; si no, de este RunAction
+    if (!fProfilerAttached) {
+        delete fSteppingAction;
+        delete fTrackingAction;
+    }
+}
+
+void RunAction::RecordCascadeTable(G4String fileName, G4int decays)
+{
+    CascadeTable::StartRecording(fileName, decays);
+}
+
+void RunAction::AddROI(G4double eMinKeV, G4double eMaxKeV)
+{
+    if (eMinKeV < 0. || eMaxKeV <= eMinKeV) {
+        G4cerr << "ERROR: ROI inválida [" << eMinKeV << ", " << eMaxKeV << "] keV" << G4endl;
+        return;
+    }
+    fROI.AddROI(eMinKeV*keV, eMaxKeV*keV);
+}
+
+void RunAction::ClearROIs()
+{
+    fROI.Clear();
+}
 
-void RunAction::BeginOfRunAction(const G4Run*)
+void RunAction::CountKilledTrack(G4int reason)
 {
+    if (reason == 0) fKilledNeutrinos += 1;
+    else if (reason == 1) fKilledIons += 1;
+    else fKilledCharged += 1;
+}
+
+G4String RunAction::GetOutputBaseName()
+{
+    G4String fileName = G4AnalysisManager::Instance()->GetFileName();
+    if (fileName.size() > 5 && fileName.substr(fileName.size() - 5) == ".root") {
+        fileName = fileName.substr(0, fileName.size() - 5);
+    }
+    return fileName;
+}
+
+void RunAction::BeginOfRunAction(const G4Run* run)
+{
+    // Señal recibida entre runs: no abrir (y pisar) otro archivo
+    if (IsMaster()) RunCheckpoint::ExitIfInterrupted();
+
+    // Run con checkpoint: el Master conserva lo acumulado en los segmentos
+    // anteriores (los workers empiezan de cero y se le suman al final)
+    G4bool continuing = IsMaster() && RunCheckpoint::IsContinuing();
+    if (!continuing) G4AccumulableManager::Instance()->Reset();
+
+    // Reproducción de un espacio de fases: se cuentan los eventos fuente leídos
+    if (IsMaster()) PhaseSpaceReader::BeginOfRun();
+
     auto analysisManager = G4AnalysisManager::Instance();
     
-    // Crear NTuple SOLO si no existe (primera vez o después de Reset)
-    if (analysisManager->GetNofNtuples() == 0) {
-        analysisManager->CreateNtuple("Scoring", "Datos por Evento");
-        analysisManager->CreateNtupleDColumn("Energy");
-        analysisManager->FinishNtuple();
+    // Crear NTuple SOLO si se pide (/MedidorTR/output/ntuple true) y no
+    // existe (primera vez o después de Reset)
+    // Una por línea: "Scoring" con una sola línea (formato de siempre),
+    // "Scoring_<copia>" en modo multi-línea.
+    auto detector = static_cast<const DetectorConstruction*>
+        (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+    if (fNtupleOutput && analysisManager->GetNofNtuples() == 0) {
+        G4int nBeamlines = detector->GetNumberOfBeamlines();
+        fSamplePaths.resize(nBeamlines);
+
+        for (G4int copy = 0; copy < nBeamlines; copy++) {
+            if (nBeamlines == 1) {
+                analysisManager->CreateNtuple("Scoring", "Datos por Evento");
+            } else {
+                analysisManager->CreateNtuple("Scoring_" + std::to_string(copy),
+                                              "Datos por Evento, linea " + std::to_string(copy));
+            }
+            analysisManager->CreateNtupleDColumn("Energy");
+            analysisManager->CreateNtupleDColumn("Weight"); // 1 salvo con fuente sesgada
+            if (detector->IsPathRecording()) {
+                // Pasos de los fotones en la muestra (MeV, mm, subtipo EM)
+                analysisManager->CreateNtupleDColumn("PathE", fSamplePaths[copy].energy);
+                analysisManager->CreateNtupleDColumn("PathL", fSamplePaths[copy].length);
+                analysisManager->CreateNtupleIColumn("PathProc", fSamplePaths[copy].process);
+            }
+            analysisManager->FinishNtuple();
+        }
+    }
+    // Creadas en un run anterior: sin salida pedida no se llenan, fusionan
+    // ni escriben (árboles vacíos)
+    if (analysisManager->GetNofNtuples() > 0) analysisManager->SetNtupleActivation(fNtupleOutput);
+
+    // Histogramas de energía depositada, uno por línea con el mismo id que
+    // su NTuple: "Energy" o "Energy_<copia>". Peso = peso del evento.
+    // Si ya existen se actualizan los bins (pueden cambiar entre runs).
+    // Con el MCA activo, un bin por canal.
+    G4int bins = fHistoBins;
+    G4double eMax = fHistoEmax;
+    if (fResponse.GetChannels() > 0) {
+        bins = fResponse.GetChannels();
+        eMax = fResponse.GetChannelEmax();
+    }
+    if (analysisManager->GetNofH1s() == 0) {
+        G4int nBeamlines = detector->GetNumberOfBeamlines();
+        for (G4int copy = 0; copy < nBeamlines; copy++) {
+            G4String suffix = (nBeamlines == 1) ? "" : "_" + std::to_string(copy);
+            analysisManager->CreateH1("Energy" + suffix, "Energia depositada" + suffix,
+                                      bins, 0., eMax, "keV");
+        }
+    } else if (!continuing) {
+        for (G4int id = 0; id < analysisManager->GetNofH1s(); id++) {
+            analysisManager->SetH1(id, bins, 0., eMax, "keV");
+        }
     }
     
+    // Registro de la concentración de cada línea (modo multi-línea)
+    if (IsMaster() && detector->GetNumberOfBeamlines() > 1) {
+        for (G4int copy = 0; copy < detector->GetNumberOfBeamlines(); copy++) {
+            G4cout << ">>> [Master] Linea " << copy << ": REE = "
+                   << detector->GetBeamlineREE(copy) << " ("
+                   << detector->GetBeamlineMaterial(copy)->GetName() << ") -> Scoring_" << copy << G4endl;
+        }
+    }
+
+    if (IsMaster()) CascadeTable::BeginOfRun(detector->GetNumberOfBeamlines());
+
+    // Reanudación: contadores e histogramas del .ckpt
+    if (IsMaster() && RunCheckpoint::IsRestoring()) LoadCheckpoint(RunCheckpoint::GetFileName());
+
+    if (IsMaster() && RunCheckpoint::IsActive() && !continuing
+        && (fNtupleOutput || detector->IsPhaseSpacePlane())) {
+        G4cerr << "WARNING: run con checkpoint: la NTuple y el espacio de fases"
+               << " guardan solo el último segmento" << G4endl;
+    }
+
+    fPrecision.BeginOfRun(detector->GetNumberOfBeamlines(), fIndex,
+                          IsMaster() ? RunCheckpoint::GetEventsBefore() : 0);
+
+    if (IsMaster() && detector->IsPathRecording() && !fNtupleOutput) {
+        G4cerr << "WARNING: /MedidorTR/reweight/record sin /MedidorTR/output/ntuple true:"
+               << " los pasos no se guardan" << G4endl;
+    }
+
+    // Espacio de fases: <archivo>.phsp, compartido por todos los hilos
+    if (IsMaster() && detector->IsPhaseSpacePlane()) {
+        G4String fileName = GetOutputBaseName();
+        PhaseSpaceWriter::Open(fileName + ".phsp", detector->GetPhaseSpaceZ());
+    }
+
     // Abrir archivo
     analysisManager->OpenFile();
+
+    if (IsMaster() && fResponse.IsEnabled()) {
+        G4cout << ">>> [Master] Resolución: FWHM(662 keV) = "
+               << fResponse.GetFWHM(662.*keV)/keV << " keV, "
+               << fResponse.GetChannels() << " canales" << G4endl;
+    }
+
+    if (IsMaster()) fTimer.Start();
+    fProgress.BeginOfRun(run, analysisManager->GetFileName());
+    fProfiler.BeginOfRun();
+
+    // El Stepping y el Tracking solo existen para el perfil: un run sin
+    // perfil no ejecuta código de usuario en cada paso
+    AttachProfiler(fProfiler.IsEnabled());
 }
 
-void RunAction::EndOfRunAction(const G4Run*)
+void RunAction::AttachProfiler(G4bool attach)
 {
+    // El Master de un run MT no procesa eventos (y no admite estas acciones)
+    G4RunManager* runManager = G4RunManager::GetRunManager();
+    if (runManager->GetRunManagerType() == G4RunManager::masterRM) return;
+    if (attach == fProfilerAttached) return;
+
+    if (!fSteppingAction) {
+        fSteppingAction = new SteppingAction(this);
+        fTrackingAction = new TrackingAction(this);
+    }
+    runManager->SetUserAction(attach ? fSteppingAction : static_cast<G4UserSteppingAction*>(nullptr));
+    runManager->SetUserAction(attach ? fTrackingAction : static_cast<G4UserTrackingAction*>(nullptr));
+    fProfilerAttached = attach;
+}
+
+void RunAction::EndOfRunAction(const G4Run* run)
+{
+    // Eventos de todo el run (con checkpoint, también los segmentos
+    // anteriores), si el Master sigue acumulando en otro segmento y si el
+    // run quedó completo (una interrupción se completa con resume)
+    G4long nEvents = run->GetNumberOfEvent();
+
+    // Reproducción: la normalización son los eventos del run original que
+    // representan los registros leídos (los pesos ya llevan 1/recycle)
+    G4long sourceEvents = IsMaster() ? PhaseSpaceReader::GetSourceEvents() : 0;
+    if (sourceEvents > 0) {
+        G4cout << ">>> [Master] Espacio de fases: " << run->GetNumberOfEvent()
+               << " eventos reproducidos = " << sourceEvents << " eventos fuente" << G4endl;
+        nEvents = sourceEvents;
+    }
+    G4bool continues = false;
+    G4bool complete = !RunCheckpoint::IsInterrupted();
+    if (IsMaster() && RunCheckpoint::IsActive()) {
+        nEvents += RunCheckpoint::GetEventsBefore();
+        continues = RunCheckpoint::EndOfSegment(run->GetNumberOfEvent());
+        complete = RunCheckpoint::IsComplete();
+    }
+
     auto analysisManager = G4AnalysisManager::Instance();
     analysisManager->Write();
-    analysisManager->CloseFile();
+    analysisManager->CloseFile(!continues);
+
+    // Tabla de cascadas: cada hilo suma la suya; los workers ya
+    // terminaron cuando el Master escribe la tabla acumulada
+    CascadeTable::FlushThread();
+    if (IsMaster()) CascadeTable::WriteRecording();
+
+    // Espacio de fases: cada hilo vuelca lo que le queda, el Master cierra
+    PhaseSpaceWriter::FlushThread();
+    if (IsMaster()) PhaseSpaceWriter::Close();
+
+    // ROIs: en el Master, Merge() suma los contadores de todos los hilos
+    G4AccumulableManager::Instance()->Merge();
+    fProgress.EndOfRun(fROI);
+    if (IsMaster()) WriteROISummary(nEvents);
+    if (IsMaster()) PrintKilledTracks(nEvents);
+
+    // Índice dual-energy: una fila por línea en el CSV de resultados
+    // (con checkpoint, solo al completar el run)
+    if (IsMaster()) {
+        auto detector = static_cast<const DetectorConstruction*>
+            (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+        if (complete) fIndex.EndOfRun(nEvents, detector, analysisManager->GetFileName());
+
+        // Repesado: secciones eficaces para el análisis, <archivo>_xs.csv
+        if (detector->IsPathRecording() && nEvents > 0) {
+            G4String fileName = GetOutputBaseName();
+            SamplePathSD::WriteCrossSectionTable(fileName + "_xs.csv", detector);
+        }
+    }
+
+    if (IsMaster() && complete) fPrecision.EndOfRun(nEvents);
+
+    // Rendimiento: tiempo real de todo el run (todos los hilos)
+    if (IsMaster()) fTimer.Stop(run);
+
+    // Perfil: cada hilo publica su tabla, el Master imprime (después de
+    // los workers) la tabla de todo el run y <archivo>_perfil.csv
+    fProfiler.EndOfRun(GetOutputBaseName());
+
+    // Checkpoint: estado acumulado + motor aleatorio; se borra al completar
+    if (IsMaster() && RunCheckpoint::IsActive()) {
+        if (RunCheckpoint::IsComplete()) RunCheckpoint::Remove();
+        else SaveCheckpoint(RunCheckpoint::GetFileName());
+    }
+
+    // SIGINT/SIGTERM: los resultados parciales ya están escritos
+    if (IsMaster()) RunCheckpoint::ExitIfInterrupted();
     
     // NO usar Reset() aquí - causa problemas entre runs consecutivos
-}
\ No newline at end of file
+}
+
+// Resumen compacto: cuentas ± error por línea y ROI, más los eventos
+// simulados. Alcanza para las curvas de transmisión sin releer el .root.
+void RunAction::WriteROISummary(G4long nEvents) const
+{
+    if (fROI.GetNumberOfROIs() == 0 || nEvents == 0) return;
+
+    G4String fileName = GetOutputBaseName();
+    fileName += "_ROI.csv";
+
+    std::ofstream file(fileName);
+    file << "# eventos: " << nEvents << "\n";
+    file << "linea,Emin_keV,Emax_keV,cuentas,error\n";
+
+    G4cout << ">>> [Master] ROIs (" << nEvents << " eventos) -> " << fileName << G4endl;
+    for (G4int copy = 0; copy < std::max(1, fROI.GetNumberOfCopies()); copy++) {
+        for (std::size_t roi = 0; roi < fROI.GetNumberOfROIs(); roi++) {
+            G4double counts = fROI.GetSumW(copy, roi);
+            G4double error = std::sqrt(fROI.GetSumW2(copy, roi));
+            file << copy << "," << fROI.GetEmin(roi)/keV << "," << fROI.GetEmax(roi)/keV
+                 << "," << counts << "," << error << "\n";
+            G4cout << "    Linea " << copy << " [" << fROI.GetEmin(roi)/keV << ", "
+                   << fROI.GetEmax(roi)/keV << "] keV: " << counts << " +/- " << error << G4endl;
+        }
+    }
+}
+
+// Secundarios que el StackingAction no llegó a seguir
+void RunAction::PrintKilledTracks(G4long nEvents) const
+{
+    G4long total = fKilledNeutrinos.GetValue() + fKilledIons.GetValue() + fKilledCharged.GetValue();
+    if (nEvents == 0 || total == 0) return;
+
+    G4cout << ">>> [Master] Tracks eliminados al crearse: " << total
+           << " (" << G4double(total) / nEvents << " por evento)" << G4endl;
+    G4cout << "    Neutrinos: " << fKilledNeutrinos.GetValue()
+           << " | Nucleos de retroceso: " << fKilledIons.GetValue()
+           << " | Electrones sin alcance: " << fKilledCharged.GetValue() << G4endl;
+}
+
+// Checkpoint (/MedidorTR/run/): una línea por bloque de estado del Master.
+// Se escribe en un temporal y se renombra, para que un corte a mitad de la
+// escritura deje el checkpoint anterior intacto.
+void RunAction::SaveCheckpoint(const G4String& fileName) const
+{
+    G4String tmpName = fileName + ".tmp";
+    {
+        std::ofstream file(tmpName);
+        file.precision(17);
+        RunCheckpoint::WriteHeader(file);
+
+        file << "roi ";
+        fROI.Write(file);
+        file << "index ";
+        fIndex.GetCounter().Write(file);
+        file << "killed " << fKilledNeutrinos.GetValue() << " " << fKilledIons.GetValue()
+             << " " << fKilledCharged.GetValue() << "\n";
+
+        // Histogramas: contenido crudo de cada bin (incluye under/overflow)
+        auto analysisManager = G4AnalysisManager::Instance();
+        for (G4int id = 0; id < analysisManager->GetNofH1s(); id++) {
+            auto h1 = analysisManager->GetH1(id);
+            if (!h1) continue;
+            unsigned int nBins = h1->axis().bins() + 2;
+            file << "h1 " << id << " " << nBins;
+            for (unsigned int bin = 0; bin < nBins; bin++) {
+                unsigned int entries = 0;
+                G4double sw = 0., sw2 = 0., sxw = 0., sx2w = 0.;
+                h1->get_bin_content(bin, entries, sw, sw2, sxw, sx2w);
+                file << " " << entries << " " << sw << " " << sw2 << " " << sxw << " " << sx2w;
+            }
+            file << "\n";
+        }
+        if (!file) {
+            G4cerr << "ERROR: no se pudo escribir el checkpoint " << tmpName << G4endl;
+            return;
+        }
+    }
+    std::rename(tmpName.c_str(), fileName.c_str());
+
+    G4cout << ">>> [Master] Checkpoint: " << RunCheckpoint::GetEventsBefore()
+           << " eventos -> " << fileName << G4endl;
+}
+
+// Se llama al empezar el primer segmento reanudado, después de crear (o
+// reiniciar) los histogramas; los contadores del Master están en cero
+void RunAction::LoadCheckpoint(const G4String& fileName)
+{
+    std::ifstream file(fileName);
+    auto analysisManager = G4AnalysisManager::Instance();
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream in(line);
+        std::string key;
+        in >> key;
+        if (key == "roi") {
+            if (!fROI.Read(in)) G4cerr << "ERROR: las ROIs no coinciden con el checkpoint" << G4endl;
+        } else if (key == "index") {
+            if (!fIndex.RestoreCounter(in)) {
+                G4cerr << "ERROR: las ventanas de /MedidorTR/index/ no coinciden con el checkpoint" << G4endl;
+            }
+        } else if (key == "killed") {
+            G4long neutrinos = 0, ions = 0, charged = 0;
+            in >> neutrinos >> ions >> charged;
+            fKilledNeutrinos += neutrinos;
+            fKilledIons += ions;
+            fKilledCharged += charged;
+        } else if (key == "h1") {
+            G4int id = -1;
+            unsigned int nBins = 0;
+            in >> id >> nBins;
+            auto h1 = (id >= 0 && id < analysisManager->GetNofH1s()) ? analysisManager->GetH1(id) : nullptr;
+            if (!h1 || h1->axis().bins() + 2 != nBins) {
+                G4cerr << "ERROR: el histograma " << id << " no coincide con el checkpoint" << G4endl;
+                continue;
+            }
+            for (unsigned int bin = 0; bin < nBins; bin++) {
+                unsigned int entries = 0;
+                G4double sw = 0., sw2 = 0., sxw = 0., sx2w = 0.;
+                in >> entries >> sw >> sw2 >> sxw >> sx2w;
+                h1->set_bin_content(bin, entries, sw, sw2, sxw, sx2w);
+            }
+        }
+    }
+    G4cout << ">>> [Master] Estado restaurado desde " << fileName << " ("
+           << RunCheckpoint::GetEventsBefore() << " eventos)" << G4endl;
+}
@@ -0,0 +1,238 @@
+#include "RunCheckpoint.hh"
+#include "RunAction.hh"
+
+#include "G4RunManager.hh"
+#include "G4MTRunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+    // Señales: el manejador solo marca la señal recibida
+    volatile std::sig_atomic_t signalReceived = 0;
+    std::atomic<G4bool> abortRequested(false);
+
+    void HandleSignal(int signal)
+    {
+        signalReceived = signal;
+        // La segunda señal ya no se atrapa: termina el proceso
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+    }
+
+    // Run segmentado en curso (solo lo toca el Master, fuera de los eventos)
+    G4bool active = false;
+    G4bool continuing = false;
+    G4bool restoring = false;
+    G4bool complete = false;
+    G4bool segmentEnded = false;
+    G4long targetEvents = 0;
+    G4long doneEvents = 0;
+    G4int  segmentEvents = 0;
+    G4int  everyEvents = 0;
+}
+
+// 1. CONSTRUCTOR
+RunCheckpoint::RunCheckpoint()
+: fMessenger(nullptr),
+  fEvery(0)
+{
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/run/", "Runs largos con checkpoint y reanudación");
+
+    // El estado del run vive en el Master: ningún comando se reenvía
+    fMessenger->DeclareProperty("checkpointEvery", fEvery,
+                                "Eventos entre checkpoints (0 = solo al interrumpir)")
+        .SetToBeBroadcasted(false);
+
+    fMessenger->DeclareMethod("beamOn", &RunCheckpoint::BeamOn,
+                              "Corre N eventos en segmentos de checkpointEvery, con checkpoint")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_Idle);
+
+    fMessenger->DeclareMethod("resume", &RunCheckpoint::Resume,
+                              "Continúa el run de <archivo>.ckpt hasta su número de eventos")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_Idle);
+
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGTERM, HandleSignal);
+}
+
+// 2. DESTRUCTOR
+RunCheckpoint::~RunCheckpoint()
+{
+    delete fMessenger;
+}
+
+// 3. COMANDOS
+void RunCheckpoint::BeamOn(G4int nEvents)
+{
+    if (nEvents <= 0) {
+        G4cerr << "ERROR: /MedidorTR/run/beamOn necesita N > 0" << G4endl;
+        return;
+    }
+    Run(nEvents, 0, false);
+}
+
+void RunCheckpoint::Resume()
+{
+    G4String fileName = GetFileName();
+    std::ifstream file(fileName);
+    if (!file) {
+        G4cerr << "ERROR: no hay checkpoint " << fileName
+               << " (¿/analysis/setFileName antes de /MedidorTR/run/resume?)" << G4endl;
+        return;
+    }
+
+    // Solo la cabecera; el estado de los contadores lo lee el RunAction
+    G4long target = 0, done = 0;
+    G4int every = 0;
+    std::string key, rndm;
+    while (file >> key) {
+        if (key == "target") file >> target;
+        else if (key == "done") file >> done;
+        else if (key == "every") file >> every;
+        else if (key == "rndm") file >> rndm;
+        else file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    if (target <= 0 || rndm.empty() || !std::ifstream(rndm).good()) {
+        G4cerr << "ERROR: checkpoint incompleto: " << fileName << G4endl;
+        return;
+    }
+
+    // Misma segmentación que el run original: mismas semillas por segmento
+    G4Random::restoreEngineStatus(rndm.c_str());
+    fEvery = every;
+
+    G4cout << ">>> Reanudando " << fileName << ": " << done << " de " << target
+           << " eventos" << G4endl;
+    Run(target, done, true);
+}
+
+// 4. BUCLE DE SEGMENTOS
+void RunCheckpoint::Run(G4long target, G4long done, G4bool restore)
+{
+    if (done >= target) {
+        G4cout << "    NOTA: el run ya estaba completo" << G4endl;
+        Remove();
+        return;
+    }
+
+    G4RunManager* runManager = G4RunManager::GetRunManager();
+    active = true;
+    continuing = false;
+    restoring = restore;
+    complete = false;
+    targetEvents = target;
+    doneEvents = done;
+    everyEvents = fEvery;
+
+    while (!complete && !IsInterrupted()) {
+        G4long remaining = targetEvents - doneEvents;
+        segmentEvents = G4int(everyEvents > 0 ? std::min<G4long>(everyEvents, remaining) : remaining);
+        segmentEnded = false;
+
+        runManager->BeamOn(segmentEvents);
+
+        // Si el run no llegó a empezar no hay EndOfRunAction
+        if (!segmentEnded) {
+            G4cerr << "ERROR: el segmento no se ejecutó; run detenido" << G4endl;
+            break;
+        }
+        continuing = true;
+        restoring = false;
+    }
+
+    active = false;
+    continuing = false;
+    restoring = false;
+}
+
+// 5. ESTADO PARA EL RUNACTION (Master)
+G4bool RunCheckpoint::IsActive()        { return active; }
+G4bool RunCheckpoint::IsContinuing()    { return active && continuing; }
+G4bool RunCheckpoint::IsRestoring()     { return active && restoring; }
+G4long RunCheckpoint::GetEventsBefore() { return active ? doneEvents : 0; }
+G4long RunCheckpoint::GetTargetEvents() { return active ? targetEvents : 0; }
+G4bool RunCheckpoint::IsComplete()      { return complete; }
+
+G4bool RunCheckpoint::EndOfSegment(G4int nEvents)
+{
+    segmentEnded = true;
+    doneEvents += nEvents;
+    if (IsInterrupted()) return false;
+
+    // Menos eventos que los pedidos: parada por precisión o fin del
+    // espacio de fases; el run se da por terminado
+    complete = (doneEvents >= targetEvents || nEvents < segmentEvents);
+    return !complete;
+}
+
+G4String RunCheckpoint::GetFileName()
+{
+    return RunAction::GetOutputBaseName() + ".ckpt";
+}
+
+void RunCheckpoint::WriteHeader(std::ostream& out)
+{
+    G4String rndm = RunAction::GetOutputBaseName() + ".rndm";
+    G4Random::saveEngineStatus(rndm.c_str());
+
+    out << "# Checkpoint de /MedidorTR/run/ (no editar)\n";
+    out << "target " << targetEvents << "\n";
+    out << "done " << doneEvents << "\n";
+    out << "every " << everyEvents << "\n";
+    out << "rndm " << rndm << "\n";
+}
+
+void RunCheckpoint::Remove()
+{
+    std::remove(GetFileName().c_str());
+    std::remove((RunAction::GetOutputBaseName() + ".rndm").c_str());
+}
+
+// 6. SEÑALES
+// Se llama al final de cada evento en todos los hilos; el primero que ve
+// la señal detiene el run (aborto suave, como la parada por precisión)
+void RunCheckpoint::CheckSignal()
+{
+    if (signalReceived == 0 || abortRequested.exchange(true)) return;
+
+    G4cerr << "WARNING: señal " << G4int(signalReceived)
+           << " recibida; se detiene el run y se escriben los resultados parciales" << G4endl;
+    if (G4Threading::IsWorkerThread()) {
+        G4MTRunManager::GetMasterRunManager()->AbortRun(true);
+    } else {
+        G4RunManager::GetRunManager()->AbortRun(true);
+    }
+}
+
+G4bool RunCheckpoint::IsInterrupted()
+{
+    return signalReceived != 0;
+}
+
+// Sin destructores ni más comandos de la macro: los archivos del run ya
+// están cerrados y un run siguiente los sobrescribiría
+void RunCheckpoint::ExitIfInterrupted()
+{
+    if (!IsInterrupted()) return;
+
+    G4int signal = signalReceived;
+    G4cout << ">>> [Master] Interrumpido por la señal " << signal;
+    if (active) G4cout << "; continuar con /MedidorTR/run/resume";
+    G4cout << G4endl;
+    std::cout.flush();
+    std::cerr.flush();
+    std::_Exit(128 + signal);
+}
@@ -0,0 +1,100 @@
+#include "SamplePathSD.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4VProcess.hh"
+#include "G4Gamma.hh"
+#include "G4EmCalculator.hh"
+#include "G4EmProcessSubType.hh"
+#include "G4Material.hh"
+#include "G4NistManager.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <fstream>
+
+// 1. CONSTRUCTOR
+SamplePathSD::SamplePathSD(const G4String& name)
+: G4VSensitiveDetector(name),
+  fPaths(1)
+{}
+
+// 2. DESTRUCTOR
+SamplePathSD::~SamplePathSD()
+{}
+
+// 3. INICIO DEL EVENTO
+void SamplePathSD::Initialize(G4HCofThisEvent*)
+{
+    for (auto& path : fPaths) path.Clear();
+}
+
+const SamplePath& SamplePathSD::GetPath(G4int copy) const
+{
+    static const SamplePath empty;
+    return (copy < G4int(fPaths.size())) ? fPaths[copy] : empty;
+}
+
+// 4. PASOS EN LA MUESTRA
+G4bool SamplePathSD::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+    if (step->GetTrack()->GetDefinition() != G4Gamma::Definition()) return false;
+
+    G4StepPoint* pre = step->GetPreStepPoint();
+    G4int copy = pre->GetTouchable()->GetCopyNumber();
+    if (copy >= G4int(fPaths.size())) fPaths.resize(copy + 1);
+
+    // Solo las cuatro interacciones del fotón cambian con el material
+    G4int process = 0;
+    const G4VProcess* defined = step->GetPostStepPoint()->GetProcessDefinedStep();
+    if (defined && defined->GetProcessType() == fElectromagnetic) {
+        G4int subType = defined->GetProcessSubType();
+        if (subType == fRayleigh || subType == fPhotoElectricEffect ||
+            subType == fComptonScattering || subType == fGammaConversion) process = subType;
+    }
+
+    SamplePath& path = fPaths[copy];
+    path.energy.push_back(pre->GetKineticEnergy());
+    path.length.push_back(step->GetStepLength());
+    path.process.push_back(process);
+    return true;
+}
+
+// 5. TABLA PARA EL REPESADO
+// mu_p(E,c) = rho(c) * [(1-c) m_p,matriz(E) + c m_p,REE(E)], con rho(c)
+// lineal entre rho(0) y rho(1), igual que BuildApatiteWithREE
+void SamplePathSD::WriteCrossSectionTable(const G4String& fileName, const DetectorConstruction* detector)
+{
+    const G4Material* materials[2] = {
+        G4Material::GetMaterial("ApatiteBase"),
+        G4NistManager::Instance()->FindOrBuildMaterial("G4_Ce")
+    };
+    const char* processes[4] = {"Rayl", "phot", "compt", "conv"};
+
+    std::ofstream file(fileName);
+    file << "# rho0_g_cm3," << detector->GetSampleDensity(0.) / (g/cm3) << "\n";
+    file << "# rho1_g_cm3," << detector->GetSampleDensity(1.) / (g/cm3) << "\n";
+    for (G4int copy = 0; copy < detector->GetNumberOfBeamlines(); copy++) {
+        file << "# ref," << copy << "," << detector->GetBeamlineREE(copy) << "\n";
+    }
+    file << "E_MeV,base_Rayl,base_phot,base_compt,base_conv,ree_Rayl,ree_phot,ree_compt,ree_conv\n";
+
+    // 1 keV - 2 MeV, 100 puntos por década (interpolación lineal en ln E)
+    G4EmCalculator calculator;
+    const G4double eMin = 1.*keV, eMax = 2.*MeV;
+    const G4int nPoints = G4int(100. * std::log10(eMax / eMin)) + 1;
+    for (G4int i = 0; i < nPoints; i++) {
+        G4double energy = eMin * std::pow(eMax / eMin, G4double(i) / (nPoints - 1));
+        file << energy / MeV;
+        for (const G4Material* material : materials) {
+            for (const char* process : processes) {
+                G4double mu = calculator.ComputeCrossSectionPerVolume(energy, G4Gamma::Definition(),
+                                                                      process, material);
+                file << "," << mu / material->GetDensity() / (cm2/g);
+            }
+        }
+        file << "\n";
+    }
+    G4cout << ">>> [Master] Tabla de repesado -> " << fileName << G4endl;
+}
@@ -0,0 +1,188 @@
+#include "ScanManager.hh"
+#include "DetectorConstruction.hh"
+#include "RunCheckpoint.hh"
+
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Timer.hh"
+
+#include <cstdio>
+#include <fstream>
+
+// 1. CONSTRUCTOR
+ScanManager::ScanManager(DetectorConstruction* detector, RunCheckpoint* checkpoint)
+: fDetector(detector),
+  fCheckpoint(checkpoint),
+  fMessenger(nullptr),
+  fStep(0.001),
+  fEvents(100000000),
+  fFilePrefix("Eu152_REE"),
+  fSkipExisting(true),
+  fPrebuiltSet(true)
+{
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/scan/", "Barrido de concentraciones REE en un solo proceso");
+
+    // Los comandos viven solo en el Master (no existen en los workers),
+    // por eso ninguno se reenvía a los hilos.
+    fMessenger->DeclareMethod("clear", &ScanManager::Clear,
+                              "Borra la lista de concentraciones del barrido")
+        .SetToBeBroadcasted(false);
+
+    fMessenger->DeclareMethod("addPoint", &ScanManager::AddPoint,
+                              "Agrega una concentración (fracción másica 0.0 - 1.0)")
+        .SetToBeBroadcasted(false);
+
+    fMessenger->DeclareMethod("addRange", &ScanManager::AddRange,
+                              "Agrega min..max (fracción másica) con el paso de setStep")
+        .SetToBeBroadcasted(false);
+
+    fMessenger->DeclareProperty("setStep", fStep,
+                                "Paso usado por addRange (fracción másica)")
+        .SetToBeBroadcasted(false);
+
+    fMessenger->DeclareProperty("setEvents", fEvents,
+                                "Eventos por punto del barrido (máximo si /MedidorTR/stop/precision > 0)")
+        .SetToBeBroadcasted(false);
+
+    fMessenger->DeclareProperty("setFilePrefix", fFilePrefix,
+                                "Prefijo del archivo de salida (ej. Eu152_REE -> Eu152_REE_0p002)")
+        .SetToBeBroadcasted(false);
+
+    fMessenger->DeclareProperty("skipExisting", fSkipExisting,
+                                "Saltar puntos cuyo archivo .root ya existe")
+        .SetToBeBroadcasted(false);
+
+    fMessenger->DeclareProperty("usePrebuiltSet", fPrebuiltSet,
+                                "Construir todos los materiales y tablas antes del primer punto")
+        .SetToBeBroadcasted(false);
+
+    fMessenger->DeclareMethod("run", &ScanManager::Run,
+                              "Ejecuta todos los puntos del barrido (un archivo por punto)")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_Idle);
+}
+
+// 2. DESTRUCTOR
+ScanManager::~ScanManager()
+{
+    delete fMessenger;
+}
+
+// 3. LISTA DE PUNTOS
+void ScanManager::Clear()
+{
+    fPoints.clear();
+}
+
+void ScanManager::AddPoint(G4double fraction)
+{
+    if (fraction < 0. || fraction > 1.) {
+        G4cerr << "ERROR: concentración fuera de rango [0,1]: " << fraction << G4endl;
+        return;
+    }
+    fPoints.push_back(fraction);
+}
+
+void ScanManager::AddRange(G4double fractionMin, G4double fractionMax)
+{
+    if (fStep <= 0.) {
+        G4cerr << "ERROR: /MedidorTR/scan/setStep debe ser > 0" << G4endl;
+        return;
+    }
+    // Se cuenta por índice para no acumular error de redondeo en x += paso
+    G4int nSteps = G4int((fractionMax - fractionMin) / fStep + 0.5);
+    for (G4int i = 0; i <= nSteps; i++) {
+        AddPoint(fractionMin + i * fStep);
+    }
+}
+
+// 4. NOMBRE DE ARCHIVO
+// Mismo formato que run_scan_fino.sh ("0.002" -> "0p002", "0.00" -> "0p00"),
+// para que AnalisisEu152_v4/v6 encuentren los archivos sin cambios.
+G4String ScanManager::FileNameFor(G4double fraction) const
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6f", fraction);
+    std::string value(buffer);
+
+    // Quitar ceros finales pero dejar al menos dos decimales
+    std::size_t dot = value.find('.');
+    while (value.size() > dot + 3 && value.back() == '0') value.pop_back();
+    value[dot] = 'p';
+
+    return fFilePrefix + "_" + value;
+}
+
+// 5. EJECUCIÓN DEL BARRIDO
+void ScanManager::Run()
+{
+    if (fPoints.empty()) {
+        G4cerr << "ERROR: barrido vacío. Use /MedidorTR/scan/addPoint o addRange" << G4endl;
+        return;
+    }
+
+    G4RunManager* runManager = G4RunManager::GetRunManager();
+    G4UImanager* UImanager = G4UImanager::GetUIpointer();
+
+    G4cout << "=== INICIO DEL BARRIDO REE (en proceso) ===" << G4endl;
+    G4cout << "    Puntos: " << fPoints.size()
+           << " | Eventos por punto: " << fEvents << G4endl;
+
+    G4Timer totalTimer;
+    totalTimer.Start();
+
+    // Puntos que se van a correr: los que ya tienen su .root se saltan
+    // (igual que el script: permite continuar un barrido interrumpido).
+    // Un .root con checkpoint pendiente es un resultado parcial.
+    std::vector<G4bool> skip(fPoints.size(), false);
+    for (std::size_t i = 0; i < fPoints.size(); i++) {
+        G4String fileName = FileNameFor(fPoints[i]);
+        G4bool pending = std::ifstream(fileName + ".ckpt").good();
+        skip[i] = fSkipExisting && !pending && std::ifstream(fileName + ".root").good();
+    }
+
+    // Con el conjunto pre-construido, cambiar de punto solo cambia el
+    // puntero del material de la muestra (ver DetectorConstruction)
+    if (fPrebuiltSet) {
+        for (std::size_t i = 0; i < fPoints.size(); i++) {
+            if (!skip[i]) fDetector->AddREEToSet(fPoints[i]);
+        }
+        fDetector->PrepareREESet();
+    }
+
+    for (std::size_t i = 0; i < fPoints.size(); i++) {
+        G4double fraction = fPoints[i];
+        G4String fileName = FileNameFor(fraction);
+
+        G4cout << ">>> [" << i + 1 << "/" << fPoints.size() << "] REE = "
+               << fraction << " (" << fraction * 100. << "%) -> " << fileName << G4endl;
+
+        if (skip[i]) {
+            G4cout << "    NOTA: " << fileName << ".root ya existe, saltando..." << G4endl;
+            continue;
+        }
+        G4bool pending = std::ifstream(fileName + ".ckpt").good();
+
+        G4Timer pointTimer;
+        pointTimer.Start();
+
+        fDetector->SetREEConcentration(fraction);
+        UImanager->ApplyCommand("/analysis/setFileName " + fileName);
+        if (pending) {
+            fCheckpoint->Resume();
+        } else if (fCheckpoint->GetEvery() > 0) {
+            fCheckpoint->BeamOn(fEvents);
+        } else {
+            runManager->BeamOn(fEvents);
+        }
+
+        pointTimer.Stop();
+        G4int elapsed = G4int(pointTimer.GetRealElapsed());
+        G4cout << ">>> Completado REE = " << fraction << " en "
+               << elapsed / 60 << "m " << elapsed % 60 << "s" << G4endl;
+    }
+
+    totalTimer.Stop();
+    G4cout << "=== BARRIDO COMPLETADO en " << totalTimer.GetRealElapsed() << " s ===" << G4endl;
+}
@@ -0,0 +1,43 @@
+#include "SpectrumCounter.hh"
+
+#include <algorithm>
+
+SpectrumCounter::SpectrumCounter(const G4String& name)
+: G4VAccumulable(name),
+  fEmax(0.)
+{}
+
+SpectrumCounter::~SpectrumCounter()
+{}
+
+void SpectrumCounter::SetBinning(G4int bins, G4double eMax)
+{
+    fEmax = eMax;
+    fSumW.assign(bins > 0 ? bins : 0, 0.);
+    fSumW2.assign(bins > 0 ? bins : 0, 0.);
+}
+
+void SpectrumCounter::Fill(G4double edep, G4double weight)
+{
+    if (fSumW.empty() || edep < 0. || edep >= fEmax) return;
+    std::size_t bin = std::size_t(edep / fEmax * fSumW.size());
+    fSumW[bin] += weight;
+    fSumW2[bin] += weight * weight;
+}
+
+// Los hilos tienen el mismo binning (los comandos se reenvían a todos)
+void SpectrumCounter::Merge(const G4VAccumulable& other)
+{
+    const SpectrumCounter& otherCounter = static_cast<const SpectrumCounter&>(other);
+    if (otherCounter.fSumW.size() != fSumW.size()) return;
+    for (std::size_t i = 0; i < fSumW.size(); i++) {
+        fSumW[i] += otherCounter.fSumW[i];
+        fSumW2[i] += otherCounter.fSumW2[i];
+    }
+}
+
+void SpectrumCounter::Reset()
+{
+    std::fill(fSumW.begin(), fSumW.end(), 0.);
+    std::fill(fSumW2.begin(), fSumW2.end(), 0.);
+}
@@ -0,0 +1,141 @@
+#include "StackingAction.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "EventAction.hh"
+#include "DetectorConstruction.hh"
+#include "CascadeTable.hh"
+
+#include "RunAction.hh"
+
+#include "G4Track.hh"
+#include "G4Gamma.hh"
+#include "G4Electron.hh"
+#include "G4Ions.hh"
+#include "G4VProcess.hh"
+#include "G4DecayProcessType.hh"
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4NistManager.hh"
+#include "G4EmCalculator.hh"
+
+#include <cstdlib>
+
+StackingAction::StackingAction(const PrimaryGeneratorAction* generator, EventAction* eventAction,
+                               RunAction* runAction)
+: G4UserStackingAction(),
+  fGenerator(generator),
+  fEventAction(eventAction),
+  fRunAction(runAction),
+  fDetector(nullptr),
+  fMessenger(nullptr),
+  fKillNeutrinos(true),
+  fKillIons(true),
+  fKillCharged(true),
+  fRangeMaterial(nullptr),
+  fCalculator(nullptr)
+{
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/stack/", "Clasificación de secundarios");
+    fMessenger->DeclareProperty("killNeutrinos", fKillNeutrinos,
+                                "Eliminar neutrinos y antineutrinos al crearse");
+    fMessenger->DeclareProperty("killIons", fKillIons,
+                                "Eliminar núcleos de retroceso estables en su estado fundamental");
+    fMessenger->DeclareProperty("killCharged", fKillCharged,
+                                "Eliminar electrones nacidos fuera del detector que no lo alcanzan");
+}
+
+StackingAction::~StackingAction()
+{
+    delete fMessenger;
+    delete fCalculator;
+}
+
+// Los núcleos excitados NO se eliminan: su desexcitación (G4ITDecay)
+// emite los gammas del Eu-152. Ningún otro núcleo pasa a la prueba de
+// alcance (un retroceso de ~10 eV tiene alcance casi nulo).
+// La prueba de alcance es solo para electrones: el alcance en aire (el más
+// largo de la geometría) contra una cota inferior de la distancia al
+// cristal. Se desprecian el bremsstrahlung y la fluorescencia que un
+// electrón frenado en el aire podría enviar al cristal (pocos fotones y de
+// baja energía para electrones de alcance menor a la distancia). Los
+// positrones se siguen siempre: sus fotones de 511 keV sí llegan.
+G4bool StackingAction::CannotScore(const G4Track* track)
+{
+    const G4ParticleDefinition* particle = track->GetParticleDefinition();
+
+    G4int pdg = std::abs(particle->GetPDGEncoding());
+    if (pdg == 12 || pdg == 14 || pdg == 16) {
+        if (!fKillNeutrinos) return false;
+        fRunAction->CountKilledTrack(0);
+        return true;
+    }
+
+    const G4Ions* ion = dynamic_cast<const G4Ions*>(particle);
+    if (ion || particle->GetParticleType() == "nucleus") {
+        if (fKillIons && ion && particle->GetPDGStable() && ion->GetExcitationEnergy() <= 0.) {
+            fRunAction->CountKilledTrack(1);
+            return true;
+        }
+        return false;
+    }
+
+    if (!fKillCharged || particle != G4Electron::Definition()) return false;
+    if (track->GetVolume() && track->GetVolume()->GetLogicalVolume() == fDetector->GetScoringVolume()) {
+        return false;
+    }
+
+    if (!fCalculator) {
+        fRangeMaterial = G4NistManager::Instance()->FindOrBuildMaterial("G4_AIR");
+        fCalculator = new G4EmCalculator();
+    }
+    G4double range = fCalculator->GetRangeFromRestricteDEDX(track->GetKineticEnergy(), particle, fRangeMaterial);
+    if (range >= fDetector->GetDistanceToDetector(track->GetPosition())) return false;
+
+    fRunAction->CountKilledTrack(2);
+    return true;
+}
+
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+    // Los primarios no tienen creador (el ion Eu-152 siempre se sigue)
+    const G4VProcess* creator = track->GetCreatorProcess();
+    if (!creator) return fUrgent;
+
+    if (!fDetector) {
+        fDetector = static_cast<const DetectorConstruction*>
+            (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+    }
+    if (CannotScore(track)) return fKill;
+
+    // Solo productos del decaimiento radiactivo. Se compara el subtipo del
+    // proceso creador (entero), no su nombre.
+    if (creator->GetProcessSubType() != DECAY_Radioactive) return fUrgent;
+
+    // ¡TRUCO! Reseteamos el reloj para que el detector la vea AHORA.
+    // (Antes se hacía en el SteppingAction, revisando cada paso de cada
+    // partícula; aquí corre una vez por track, antes de su primer paso.)
+    G4Track* product = const_cast<G4Track*>(track);
+    product->SetGlobalTime(0.0);
+    product->SetLocalTime(0.0);
+
+    // Solo gammas recién creados por el decaimiento (no los de la cascada
+    // electromagnética, que ya vienen de un fotón/electrón con peso)
+    if (track->GetDefinition() != G4Gamma::Definition()) return fUrgent;
+
+    G4bool recording = CascadeTable::IsRecording();
+    if (!recording && !fGenerator->IsBiasEnabled()) return fUrgent;
+
+    // La línea se identifica por la posición X del decaimiento
+    G4int copy = fDetector->GetBeamlineAt(track->GetPosition().x());
+
+    // Tabla de cascadas: se guarda la energía tal como la emite el decaimiento
+    if (recording) fEventAction->AddCascadeGamma(track->GetKineticEnergy(), copy);
+    if (!fGenerator->IsBiasEnabled()) return fUrgent;
+
+    // El track aún no ha dado ningún paso: cambiar su dirección es
+    // equivalente a que el decaimiento lo hubiera emitido así
+    G4ThreeVector direction;
+    G4double weight = fGenerator->SampleBiasedDirection(direction);
+    product->SetMomentumDirection(direction);
+    fEventAction->MultiplyWeight(weight, copy);
+
+    return fUrgent;
+}
@@ -0,0 +1,240 @@
+#include "StepProfiler.hh"
+
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4VProcess.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace
+{
+    struct Totals
+    {
+        G4long   steps = 0;
+        G4long   tracks = 0;
+        G4double seconds = 0.;
+    };
+    using Names = std::array<std::string, 3>; // Volumen, partícula, proceso
+
+    // Registro global: configuración del run y tablas publicadas por hilo
+    G4Mutex profileMutex = G4MUTEX_INITIALIZER;
+    G4bool  enabled = false;
+    G4int   sampleEvery = 100;
+    G4int   topRows = 20;
+    std::map<Names, Totals> merged;
+
+    // Suma por una sola de las tres columnas, ordenada por tiempo
+    std::vector<std::pair<std::string, Totals>> GroupBy(const std::map<Names, Totals>& table, G4int column)
+    {
+        std::map<std::string, Totals> groups;
+        for (const auto& entry : table) {
+            Totals& group = groups[entry.first[column]];
+            group.steps += entry.second.steps;
+            group.tracks += entry.second.tracks;
+            group.seconds += entry.second.seconds;
+        }
+        std::vector<std::pair<std::string, Totals>> sorted(groups.begin(), groups.end());
+        std::sort(sorted.begin(), sorted.end(),
+                  [](const auto& a, const auto& b) { return a.second.seconds > b.second.seconds; });
+        return sorted;
+    }
+}
+
+// 1. CONSTRUCTOR
+StepProfiler::StepProfiler()
+: fMessenger(nullptr),
+  fEnable(false),
+  fSampleEvery(100),
+  fTop(20),
+  fEnabled(false),
+  fSample(100),
+  fStepCount(0),
+  fArmed(false),
+  fLastKey{nullptr, nullptr, nullptr},
+  fLast(nullptr)
+{
+    if (!G4Threading::IsMasterThread()) return;
+
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/profile/", "Perfil de pasos y tiempo por volumen, partícula y proceso");
+    fMessenger->DeclareProperty("enable", fEnable,
+                                "Contar pasos, tracks y tiempo por (volumen, partícula, proceso)")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareProperty("sampleEvery", fSampleEvery,
+                                "Pasos entre mediciones de tiempo (1 = todos, más lento)")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareProperty("top", fTop,
+                                "Filas de la tabla impresa al final del run")
+        .SetToBeBroadcasted(false);
+}
+
+// 2. DESTRUCTOR
+StepProfiler::~StepProfiler()
+{
+    delete fMessenger;
+}
+
+std::size_t StepProfiler::KeyHash::operator()(const Key& key) const
+{
+    std::hash<const void*> hash;
+    std::size_t seed = hash(key.volume);
+    seed ^= hash(key.particle) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    seed ^= hash(key.process) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
+// 3. INICIO DEL RUN
+// El Master empieza antes que los workers: publica la configuración
+void StepProfiler::BeginOfRun()
+{
+    G4AutoLock lock(&profileMutex);
+    if (G4Threading::IsMasterThread()) {
+        enabled = fEnable;
+        sampleEvery = std::max(1, fSampleEvery);
+        topRows = std::max(1, fTop);
+        merged.clear();
+    }
+    fEnabled = enabled;
+    fSample = sampleEvery;
+    lock.unlock();
+
+    fStepCount = 0;
+    fArmed = false;
+    fTable.clear();
+    fLast = nullptr;
+}
+
+// 4. CONTEO (hilo que procesa eventos)
+StepProfiler::Counters& StepProfiler::Find(const Key& key)
+{
+    if (fLast && key == fLastKey) return *fLast;
+    fLastKey = key;
+    fLast = &fTable[key]; // Las referencias sobreviven al rehash
+    return *fLast;
+}
+
+void StepProfiler::RecordTrack(const G4Track* track)
+{
+    const G4VPhysicalVolume* volume = track->GetVolume();
+    Key key{volume ? volume->GetLogicalVolume() : nullptr, track->GetParticleDefinition(),
+            track->GetCreatorProcess()};
+    Find(key).tracks++;
+
+    // Una muestra pendiente mide el primer paso de este track, sin el
+    // tiempo entre tracks (pila, fin del evento, generador)
+    if (fArmed) fStart = Clock::now();
+}
+
+void StepProfiler::RecordStep(const G4Step* step)
+{
+    Clock::time_point now;
+    G4bool timed = fArmed;
+    if (timed) now = Clock::now();
+
+    const G4VPhysicalVolume* volume = step->GetPreStepPoint()->GetPhysicalVolume();
+    Key key{volume ? volume->GetLogicalVolume() : nullptr, step->GetTrack()->GetParticleDefinition(),
+            step->GetPostStepPoint()->GetProcessDefinedStep()};
+    Counters& counters = Find(key);
+    counters.steps++;
+
+    if (timed) {
+        counters.seconds += std::chrono::duration<G4double>(now - fStart).count() * fSample;
+        fArmed = false;
+    }
+    if (++fStepCount % fSample == 0) {
+        fArmed = true;
+        fStart = Clock::now();
+    }
+}
+
+// 5. FIN DEL RUN
+// Los workers terminan antes que el Master: publican su tabla por nombre
+// y el Master (que en modo secuencial también tiene la suya) imprime
+void StepProfiler::EndOfRun(const G4String& baseName)
+{
+    if (!fEnabled) return;
+
+    G4AutoLock lock(&profileMutex);
+    for (const auto& entry : fTable) {
+        const Key& key = entry.first;
+        Names names{key.volume ? std::string(key.volume->GetName()) : "(fuera)",
+                    key.particle ? std::string(key.particle->GetParticleName()) : "?",
+                    key.process ? std::string(key.process->GetProcessName()) : "(primario)"};
+        Totals& totals = merged[names];
+        totals.steps += entry.second.steps;
+        totals.tracks += entry.second.tracks;
+        totals.seconds += entry.second.seconds;
+    }
+    fTable.clear();
+    fLast = nullptr;
+    if (!G4Threading::IsMasterThread() || merged.empty()) return;
+
+    std::map<Names, Totals> table;
+    table.swap(merged);
+    lock.unlock();
+
+    Totals total;
+    for (const auto& entry : table) {
+        total.steps += entry.second.steps;
+        total.tracks += entry.second.tracks;
+        total.seconds += entry.second.seconds;
+    }
+    auto percent = [](G4double part, G4double whole) { return whole > 0. ? 100. * part / whole : 0.; };
+
+    std::vector<std::pair<Names, Totals>> rows(table.begin(), table.end());
+    std::sort(rows.begin(), rows.end(),
+              [](const auto& a, const auto& b) { return a.second.seconds > b.second.seconds; });
+
+    G4cout << ">>> [Master] Perfil: " << total.steps << " pasos, " << total.tracks << " tracks, ~"
+           << total.seconds << " s de hilo (tiempo muestreado 1 de cada " << sampleEvery << " pasos)" << G4endl;
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "    %-16s %-12s %-20s %12s %7s %10s %10s %7s %8s",
+                  "volumen", "particula", "proceso", "pasos", "%pasos", "tracks", "tiempo_s", "%tiempo", "ns/paso");
+    G4cout << line << G4endl;
+    for (std::size_t i = 0; i < rows.size() && G4int(i) < topRows; i++) {
+        const Names& names = rows[i].first;
+        const Totals& row = rows[i].second;
+        std::snprintf(line, sizeof(line), "    %-16s %-12s %-20s %12ld %6.1f%% %10ld %10.2f %6.1f%% %8.0f",
+                      names[0].c_str(), names[1].c_str(), names[2].c_str(), row.steps,
+                      percent(row.steps, total.steps), row.tracks, row.seconds,
+                      percent(row.seconds, total.seconds),
+                      row.steps > 0 ? 1.e9 * row.seconds / row.steps : 0.);
+        G4cout << line << G4endl;
+    }
+
+    // Totales por columna: las decisiones (cortes, kills, sesgo) suelen
+    // ser por volumen, por partícula o por proceso
+    const char* labels[3] = {"Por volumen: ", "Por particula: ", "Por proceso: "};
+    for (G4int column = 0; column < 3; column++) {
+        auto groups = GroupBy(table, column);
+        G4cout << "    " << labels[column];
+        for (std::size_t i = 0; i < groups.size() && i < 8; i++) {
+            std::snprintf(line, sizeof(line), "%s%s %.1f%%", i ? " | " : "", groups[i].first.c_str(),
+                          percent(groups[i].second.seconds, total.seconds));
+            G4cout << line;
+        }
+        G4cout << G4endl;
+    }
+
+    // Tabla completa para el análisis
+    G4String csvName = baseName + "_perfil.csv";
+    std::ofstream csv(csvName);
+    csv << "volumen,particula,proceso,pasos,tracks,tiempo_s\n";
+    for (const auto& row : rows) {
+        csv << row.first[0] << "," << row.first[1] << "," << row.first[2] << ","
+            << row.second.steps << "," << row.second.tracks << "," << row.second.seconds << "\n";
+    }
+    G4cout << "    Tabla completa -> " << csvName << G4endl;
+}
@@ -0,0 +1,16 @@
+#include "TrackingAction.hh"
+#include "RunAction.hh"
+#include "StepProfiler.hh"
+
+TrackingAction::TrackingAction(RunAction* runAction)
+: G4UserTrackingAction(),
+  fProfiler(runAction->GetProfiler())
+{}
+
+TrackingAction::~TrackingAction()
+{}
+
+void TrackingAction::PreUserTrackingAction(const G4Track* track)
+{
+    fProfiler->PreTrack(track);
+}
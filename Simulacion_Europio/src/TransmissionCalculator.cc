@@ -0,0 +1,212 @@
+#include "TransmissionCalculator.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4EmCalculator.hh"
+#include "G4Material.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+// 1. CONSTRUCTOR
+TransmissionCalculator::TransmissionCalculator(DetectorConstruction* detector)
+: fDetector(detector),
+  fMessenger(nullptr),
+  fStep(0.001),
+  fQLow(121.78*keV), fQHigh(344.28*keV),
+  fRLow(59.54*keV), fRHigh(511.0*keV),
+  fFilePrefix("Transmision_calculada")
+{
+    // Líneas por defecto: Am-241, Eu-152 (Q y altas) y Na-22
+    for (G4double energy : {59.54, 121.78, 344.28, 511.0, 778.90, 1408.01}) AddLine(energy);
+
+    // Solo Master: no hay eventos, todo se calcula en el hilo principal
+    fMessenger = new G4GenericMessenger(this, "/MedidorTR/calc/", "Transmisión de haz estrecho (sin eventos)");
+    fMessenger->DeclareMethod("addLine", &TransmissionCalculator::AddLine,
+                              "Agrega una energía en keV")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("clearLines", &TransmissionCalculator::ClearLines,
+                              "Borra la lista de energías")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("setQLines", &TransmissionCalculator::SetQLines,
+                              "Líneas de Q = T(baja)/T(alta): <Elow> <Ehigh> en keV")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("setRLines", &TransmissionCalculator::SetRLines,
+                              "Líneas de R = lnT(baja)/lnT(alta): <Elow> <Ehigh> en keV")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("addPoint", &TransmissionCalculator::AddPoint,
+                              "Agrega una concentración (fracción másica 0.0 - 1.0)")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("addRange", &TransmissionCalculator::AddRange,
+                              "Agrega min..max (fracción másica) con el paso de setStep")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareProperty("setStep", fStep,
+                                "Paso usado por addRange (fracción másica)")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("clearPoints", &TransmissionCalculator::ClearPoints,
+                              "Borra la grilla de concentraciones")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareProperty("setFilePrefix", fFilePrefix,
+                                "Prefijo de los CSV (<prefijo>_lineas.csv, <prefijo>_indices.csv)")
+        .SetToBeBroadcasted(false);
+    fMessenger->DeclareMethod("run", &TransmissionCalculator::Run,
+                              "Calcula la grilla completa (requiere /run/initialize)")
+        .SetToBeBroadcasted(false)
+        .SetStates(G4State_Idle);
+}
+
+// 2. DESTRUCTOR
+TransmissionCalculator::~TransmissionCalculator()
+{
+    delete fMessenger;
+}
+
+// 3. CONFIGURACIÓN
+void TransmissionCalculator::AddLine(G4double energyKeV)
+{
+    if (energyKeV <= 0.) {
+        G4cerr << "ERROR: energía inválida " << energyKeV << " keV" << G4endl;
+        return;
+    }
+    fLines.push_back(energyKeV*keV);
+}
+
+void TransmissionCalculator::ClearLines()
+{
+    fLines.clear();
+}
+
+void TransmissionCalculator::SetQLines(G4double eLowKeV, G4double eHighKeV)
+{
+    fQLow = eLowKeV*keV;
+    fQHigh = eHighKeV*keV;
+}
+
+void TransmissionCalculator::SetRLines(G4double eLowKeV, G4double eHighKeV)
+{
+    fRLow = eLowKeV*keV;
+    fRHigh = eHighKeV*keV;
+}
+
+void TransmissionCalculator::AddPoint(G4double fraction)
+{
+    if (fraction < 0. || fraction > 1.) {
+        G4cerr << "ERROR: concentración fuera de rango [0,1]: " << fraction << G4endl;
+        return;
+    }
+    fPoints.push_back(fraction);
+}
+
+void TransmissionCalculator::AddRange(G4double fractionMin, G4double fractionMax)
+{
+    if (fStep <= 0.) {
+        G4cerr << "ERROR: /MedidorTR/calc/setStep debe ser > 0" << G4endl;
+        return;
+    }
+    // Igual que ScanManager: por índice, sin acumular redondeo
+    G4int nSteps = G4int((fractionMax - fractionMin) / fStep + 0.5);
+    for (G4int i = 0; i <= nSteps; i++) {
+        AddPoint(fractionMin + i * fStep);
+    }
+}
+
+void TransmissionCalculator::ClearPoints()
+{
+    fPoints.clear();
+}
+
+// 4. COEFICIENTE DE ATENUACIÓN
+// Atenuación total de haz estrecho (incluye Rayleigh), mismo material que
+// construye DetectorConstruction para esa concentración
+G4double TransmissionCalculator::Attenuation(G4double energy, G4double fraction) const
+{
+    G4EmCalculator calculator;
+    G4double length = calculator.ComputeGammaAttenuationLength(energy, fDetector->BuildApatiteWithREE(fraction));
+    return (length > 0.) ? 1. / length : 0.;
+}
+
+// 5. CÁLCULO DE LA GRILLA
+void TransmissionCalculator::Run()
+{
+    if (fPoints.empty() || fLines.empty()) {
+        G4cerr << "ERROR: grilla vacía. Use /MedidorTR/calc/addPoint o addRange y addLine" << G4endl;
+        return;
+    }
+
+    // c = 0 siempre: es la normalización de Q/Q0 (queda primero al ordenar)
+    std::vector<G4double> points = fPoints;
+    points.push_back(0.);
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+
+    // Los materiales se crean antes de inicializar los modelos EM; un run
+    // de 0 eventos construye las tablas sin llamar a las acciones de usuario
+    for (G4double fraction : points) fDetector->BuildApatiteWithREE(fraction);
+    G4RunManager::GetRunManager()->BeamOn(0);
+
+    G4double thickness = fDetector->GetSampleThickness();
+    std::size_t nPoints = points.size();
+
+    // ln T por (línea, concentración), más las líneas de Q y R
+    std::vector<G4double> energies = fLines;
+    for (G4double energy : {fQLow, fQHigh, fRLow, fRHigh}) {
+        if (std::find(energies.begin(), energies.end(), energy) == energies.end()) energies.push_back(energy);
+    }
+    std::vector<std::vector<G4double>> lnT(energies.size(), std::vector<G4double>(nPoints));
+    for (std::size_t line = 0; line < energies.size(); line++) {
+        for (std::size_t i = 0; i < nPoints; i++) {
+            lnT[line][i] = -Attenuation(energies[line], points[i]) * thickness;
+        }
+    }
+    auto index = [&](G4double energy) {
+        return std::size_t(std::find(energies.begin(), energies.end(), energy) - energies.begin());
+    };
+
+    // Derivada respecto de c: centrada en el interior, lateral en los bordes
+    auto derivative = [&](const std::vector<G4double>& y, std::size_t i) {
+        if (nPoints < 2) return 0.;
+        std::size_t a = (i == 0) ? 0 : i - 1;
+        std::size_t b = (i == nPoints - 1) ? i : i + 1;
+        return (y[b] - y[a]) / (points[b] - points[a]);
+    };
+
+    // Por línea: mu, T, ln T y d(ln T)/dc
+    std::ofstream lines(fFilePrefix + "_lineas.csv");
+    lines << "REE,E_keV,mu_cm-1,T,lnT,dlnT_dc\n";
+    for (std::size_t line = 0; line < fLines.size(); line++) {
+        std::size_t k = index(fLines[line]);
+        for (std::size_t i = 0; i < nPoints; i++) {
+            lines << points[i] << "," << energies[k]/keV << "," << -lnT[k][i] / thickness * cm << ","
+                  << std::exp(lnT[k][i]) << "," << lnT[k][i] << "," << derivative(lnT[k], i) << "\n";
+        }
+    }
+
+    // Índices: Q/Q0, con Q = T_low/T_high y Q0 el de 0% REE (la
+    // eficiencia, la intensidad y la matriz de apatita se cancelan), y
+    // R = ln T_low / ln T_high
+    std::vector<G4double> Q(nPoints), R(nPoints);
+    std::size_t qLow = index(fQLow), qHigh = index(fQHigh);
+    std::size_t rLow = index(fRLow), rHigh = index(fRHigh);
+    G4double lnQ0 = lnT[qLow][0] - lnT[qHigh][0]; // points[0] = 0
+    for (std::size_t i = 0; i < nPoints; i++) {
+        Q[i] = std::exp(lnT[qLow][i] - lnT[qHigh][i] - lnQ0);
+        R[i] = (lnT[rHigh][i] != 0.) ? lnT[rLow][i] / lnT[rHigh][i] : 0.;
+    }
+
+    std::ofstream indices(fFilePrefix + "_indices.csv");
+    indices << "REE,T_Qlow,T_Qhigh,Q_rel,dQrel_dc,T_Rlow,T_Rhigh,R,dR_dc\n";
+    G4cout << "=== TRANSMISIÓN DE HAZ ESTRECHO (espesor " << thickness/cm << " cm) ===" << G4endl;
+    G4cout << "    REE      Q/Q0        d(Q/Q0)/dc  R          dR/dc" << G4endl;
+    for (std::size_t i = 0; i < nPoints; i++) {
+        indices << points[i] << "," << std::exp(lnT[qLow][i]) << "," << std::exp(lnT[qHigh][i]) << ","
+                << Q[i] << "," << derivative(Q, i) << ","
+                << std::exp(lnT[rLow][i]) << "," << std::exp(lnT[rHigh][i]) << ","
+                << R[i] << "," << derivative(R, i) << "\n";
+        G4cout << "    " << points[i] << "  " << Q[i] << "  " << derivative(Q, i)
+               << "  " << R[i] << "  " << derivative(R, i) << G4endl;
+    }
+    G4cout << "=== " << fFilePrefix << "_lineas.csv / " << fFilePrefix << "_indices.csv ===" << G4endl;
+}
@@ -0,0 +1,37 @@
+#!/bin/bash
+# =============================================================
+# test_multilinea_scan.sh - Barrido de dos líneas: material por línea
+# =============================================================
+# Uso (lo llama ctest desde el directorio de construcción):
+#   ./test_multilinea_scan.sh [ejecutable]
+# Corre test_multilinea_scan.mac y revisa cada línea del log
+#   ">>> [Master] Linea <copia>: REE = <x> (<material>) -> Scoring_<copia>"
+# El material tiene que ser Apatite_doped_<x> de la concentración que
+# se informa; si no, la línea quedó con el material del punto anterior.
+
+EXEC=${1:-./Simulacion_Europio}
+LOG=test_multilinea_scan.log
+
+if ! G4FORCENUMBEROFTHREADS=2 "$EXEC" test_multilinea_scan.mac > "$LOG" 2>&1; then
+    echo "ERROR: falló $EXEC test_multilinea_scan.mac (ver $LOG)"
+    exit 1
+fi
+rm -f test_multilinea_*.root test_multilinea_*_ROI.csv
+
+# Dos barridos x dos puntos x dos líneas
+grep ">>> \[Master\] Linea " "$LOG" | awk '
+    {
+        ree = $7; material = $8
+        gsub(/[()]/, "", material)
+        expected = sprintf("Apatite_doped_%.6f", ree)
+        n++
+        if (material != expected) {
+            printf "ERROR: %s %s REE = %s pero material %s (esperado %s)\n", $3, $4, ree, material, expected
+            bad++
+        }
+    }
+    END {
+        if (n != 8) { printf "ERROR: %d líneas de material en el log (esperadas 8)\n", n; exit 1 }
+        if (bad) exit 1
+        print "OK: las dos líneas siguen a setREE en todos los puntos"
+    }'
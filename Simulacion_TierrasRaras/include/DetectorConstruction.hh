@@ -11,6 +11,7 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     virtual ~DetectorConstruction();
 
     virtual G4VPhysicalVolume* Construct();
+    virtual void ConstructSDandField(); // Scorer "Detector/eDep" en Det_LV
     
     G4LogicalVolume* GetScoringVolume() const { return fScoringVolume; }
 
@@ -3,6 +3,9 @@
 
 #include "G4UserRunAction.hh"
 #include "G4Run.hh"
+#include "RunTimer.hh"
+
+class G4GenericMessenger;
 
 class RunAction : public G4UserRunAction
 {
@@ -12,5 +15,19 @@ class RunAction : public G4UserRunAction
 
     virtual void BeginOfRunAction(const G4Run*);
     virtual void   EndOfRunAction(const G4Run*);
+
+    // Salida (/MedidorTR/output/): histograma H1 por hilo, fusionado al
+    // final del run (por defecto), y/o la NTuple con una fila por evento
+    G4bool IsHistoOutput() const  { return fHistoOutput; }
+    G4bool IsNtupleOutput() const { return fNtupleOutput; }
+
+  private:
+    RunTimer fTimer; // Rendimiento del run (eventos/s, solo Master)
+
+    G4GenericMessenger* fMessenger;
+    G4bool   fHistoOutput;  // Llenar el H1 "Energy"
+    G4bool   fNtupleOutput; // Llenar la NTuple "Coincidencia" (una fila por evento)
+    G4int    fHistoBins;    // Número de bins del H1
+    G4double fHistoEmax;    // Energía máxima del H1 (mínima = 0)
 };
 #endif
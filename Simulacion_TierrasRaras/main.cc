@@ -8,15 +8,23 @@
 #include "PrimaryGeneratorAction.hh"
 #include "RunAction.hh"
 #include "EventAction.hh"
+#include "CommandLine.hh"
 
 int main(int argc, char** argv)
 {
-  // 1. Detectar modo (Interactivo o Batch)
+  // 1. Línea de comandos y modo (Interactivo o Batch)
+  // Sin --threads quedan los hilos por defecto de Geant4, como antes
+  CommandLine options(0);
+  if (!options.Parse(argc, argv)) return options.IsHelp() ? 0 : 1;
+
   G4UIExecutive* ui = nullptr;
-  if (argc == 1) { ui = new G4UIExecutive(argc, argv); }
+  if (options.IsInteractive()) { ui = new G4UIExecutive(argc, argv); }
 
   // 2. Crear RunManager
-  auto* runManager = G4RunManagerFactory::CreateRunManager();
+  auto* runManager = G4RunManagerFactory::CreateRunManager(options.GetRunManagerType());
+
+  // Hilos, semilla, lotes de eventos y directorio de salida
+  if (!options.Apply(runManager)) { delete ui; delete runManager; return 1; }
 
   // 3. Inicializar Clases de Usuario (Tu Física y Geometría)
   runManager->SetUserInitialization(new DetectorConstruction());
@@ -39,15 +47,14 @@ int main(int argc, char** argv)
   // 6. Obtener puntero al UI Manager
   G4UImanager* UImanager = G4UImanager::GetUIpointer();
 
-  if ( ! ui ) {
-    // Modo Batch (lectura de macro)
-    G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command+fileName);
+  // Modo Batch: las macros en orden (y salir, salvo --interactive)
+  for (const auto& fileName : options.GetMacros()) {
+    UImanager->ApplyCommand("/control/execute " + fileName);
   }
-  else {
+
+  if ( ui ) {
     // Modo Interactivo
-    UImanager->ApplyCommand("/control/execute init_vis.mac");
+    if (options.GetMacros().empty()) UImanager->ApplyCommand("/control/execute init_vis.mac");
     ui->SessionStart();
     delete ui;
   }
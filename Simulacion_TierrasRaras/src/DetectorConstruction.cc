@@ -8,6 +8,9 @@
 #include "G4SystemOfUnits.hh"
 #include "G4VisAttributes.hh"
 #include "G4Color.hh"
+#include "G4SDManager.hh"
+#include "G4MultiFunctionalDetector.hh"
+#include "G4PSEnergyDeposit.hh"
 
 DetectorConstruction::DetectorConstruction()
 : G4VUserDetectorConstruction(),
@@ -112,4 +115,15 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
   fScoringVolume = logicDet;
 
   return physWorld;
-}
\ No newline at end of file
+}
+
+// Detector sensible (uno por hilo): el scorer suma la energía depositada en
+// Det_LV por número de copia (0 = Tag, 1 = Medida). Solo corre en los
+// pasos dentro de los cristales.
+void DetectorConstruction::ConstructSDandField()
+{
+  auto detector = new G4MultiFunctionalDetector("Detector");
+  G4SDManager::GetSDMpointer()->AddNewDetector(detector);
+  detector->RegisterPrimitive(new G4PSEnergyDeposit("eDep"));
+  SetSensitiveDetector(fScoringVolume, detector);
+}
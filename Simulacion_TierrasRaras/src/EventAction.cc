@@ -2,9 +2,13 @@
 #include "RunAction.hh"
 #include "G4AnalysisManager.hh"
 #include "G4Event.hh"
+#include "G4SDManager.hh"
+#include "G4THitsMap.hh"
 
-EventAction::EventAction()
+EventAction::EventAction(RunAction* runAction)
 : G4UserEventAction(),
+  fRunAction(runAction),
+  fEdepHCID(-1),
   fEdep(0.)
 {}
 
@@ -16,15 +20,31 @@ void EventAction::BeginOfEventAction(const G4Event*)
   fEdep = 0.;
 }
 
-void EventAction::EndOfEventAction(const G4Event*)
+void EventAction::EndOfEventAction(const G4Event* event)
 {
   auto analysisManager = G4AnalysisManager::Instance();
 
+  // Energía depositada en Det_LV (ver ConstructSDandField). Como antes con
+  // el SteppingAction, se suman las dos copias del detector.
+  if (fEdepHCID < 0) {
+    fEdepHCID = G4SDManager::GetSDMpointer()->GetCollectionID("Detector/eDep");
+  }
+  G4HCofThisEvent* hce = event->GetHCofThisEvent();
+  auto edepMap = hce ? static_cast<G4THitsMap<G4double>*>(hce->GetHC(fEdepHCID)) : nullptr;
+  if (edepMap) {
+    for (const auto& entry : *edepMap->GetMap()) fEdep += *entry.second;
+  }
+
   // OPTIMIZACIÓN: Solo guardar si hubo impacto real (> 0).
   // Con 1 Millón de eventos, cada hilo verá al menos unos 300 impactos,
   // así que no habrá archivos vacíos y no fallará.
   if (fEdep > 0.) { 
-      analysisManager->FillNtupleDColumn(0, fEdep);
-      analysisManager->AddNtupleRow();
+      if (fRunAction->IsHistoOutput()) {
+          analysisManager->FillH1(0, fEdep);
+      }
+      if (fRunAction->IsNtupleOutput()) {
+          analysisManager->FillNtupleDColumn(0, fEdep); // Columna 0
+          analysisManager->AddNtupleRow(); // Cerrar fila
+      }
   }
 }
\ No newline at end of file
@@ -4,7 +4,6 @@
 #include "G4GeneralParticleSource.hh" // <--- CAMBIO: Usamos GPS
 #include "G4SystemOfUnits.hh"
 #include "G4Event.hh"
-#include "SteppingAction.hh" // <--- AGREGAR ESTO
 
 // --- Inicialización ---
 PrimaryGeneratorAction::PrimaryGeneratorAction()
@@ -22,13 +21,13 @@ void PrimaryGeneratorAction::BuildForMaster() const
 void PrimaryGeneratorAction::Build() const
 {
   SetUserAction(new PrimaryGenerator());
-  SetUserAction(new RunAction());
+  RunAction* runAction = new RunAction(); // El EventAction lee el tipo de salida
+  SetUserAction(runAction);
   
-  // CUIDADO AQUÍ: El SteppingAction necesita puntero al EventAction
-  EventAction* eventAction = new EventAction();
+  EventAction* eventAction = new EventAction(runAction);
   SetUserAction(eventAction);
-  
-  SetUserAction(new SteppingAction(eventAction)); // <--- CONEXIÓN FINAL
+
+  // Sin SteppingAction: el scoring lo hace el detector sensible
 }
 
 // --- Generador Real ---
@@ -1,8 +1,16 @@
 #include "RunAction.hh"
 #include "G4AnalysisManager.hh"
 #include "G4Run.hh" // Necesario para obtener el ID del Run
+#include "G4GenericMessenger.hh"
+#include "G4SystemOfUnits.hh"
 
-RunAction::RunAction() : G4UserRunAction()
+RunAction::RunAction()
+: G4UserRunAction(),
+  fMessenger(nullptr),
+  fHistoOutput(true),
+  fNtupleOutput(false),
+  fHistoBins(1600),
+  fHistoEmax(1600.*keV)
 {
   auto analysisManager = G4AnalysisManager::Instance();
   analysisManager->SetDefaultFileType("root");
@@ -10,14 +18,25 @@ RunAction::RunAction() : G4UserRunAction()
   
   // ACTIVAR FUSIÓN DE HILOS
   analysisManager->SetNtupleMerging(true); 
+  analysisManager->SetActivation(true); // La NTuple se apaga con /MedidorTR/output/ntuple false
 
-  analysisManager->CreateNtuple("Coincidencia", "Datos Tierras Raras");
-  analysisManager->CreateNtupleDColumn("Energy");
-  analysisManager->FinishNtuple();
+  // Tipo de salida: el Master y los workers deben tener los mismos bins
+  // para fusionar los histogramas (los comandos se reenvían a los hilos)
+  fMessenger = new G4GenericMessenger(this, "/MedidorTR/output/", "Salida de la simulación");
+  fMessenger->DeclareProperty("histo", fHistoOutput,
+                              "Llenar el histograma Energy (tamaño fijo, no crece con los eventos)");
+  fMessenger->DeclareProperty("ntuple", fNtupleOutput,
+                              "Llenar la NTuple Coincidencia (una fila por evento con depósito)");
+  fMessenger->DeclareProperty("histoBins", fHistoBins,
+                              "Número de bins del histograma Energy");
+  fMessenger->DeclarePropertyWithUnit("histoEmax", "keV", fHistoEmax,
+                                      "Energía máxima del histograma Energy");
 }
 
 RunAction::~RunAction()
 {
+  delete fMessenger;
+
   // --- CORRECCIÓN DEL SEGMENTATION FAULT ---
   // NO borres la instancia aquí. Geant4 maneja el ciclo de vida del Singleton.
   // delete G4AnalysisManager::Instance(); <--- ESTA LINEA CAUSABA EL CRASH
@@ -26,6 +45,24 @@ RunAction::~RunAction()
 void RunAction::BeginOfRunAction(const G4Run* run)
 {
   auto analysisManager = G4AnalysisManager::Instance();
+
+  // Crear NTuple SOLO si se pide (/MedidorTR/output/ntuple true) y no
+  // existe todavía; creada en un run anterior, sin salida pedida no se
+  // llena, fusiona ni escribe (árbol vacío)
+  if (fNtupleOutput && analysisManager->GetNofNtuples() == 0) {
+    analysisManager->CreateNtuple("Coincidencia", "Datos Tierras Raras");
+    analysisManager->CreateNtupleDColumn("Energy");
+    analysisManager->FinishNtuple();
+  }
+  if (analysisManager->GetNofNtuples() > 0) analysisManager->SetNtupleActivation(fNtupleOutput);
+
+  // Histograma de energía depositada (keV), fusionado al final del run.
+  // Si ya existe se actualizan los bins (pueden cambiar entre runs).
+  if (analysisManager->GetNofH1s() == 0) {
+    analysisManager->CreateH1("Energy", "Energia depositada", fHistoBins, 0., fHistoEmax, "keV");
+  } else {
+    analysisManager->SetH1(0, fHistoBins, 0., fHistoEmax, "keV");
+  }
   
   // --- CORRECCIÓN DE SOBRESCRITURA ---
   // Obtenemos el ID de la corrida (0 para Na22, 1 para Am241)
@@ -36,11 +73,16 @@ void RunAction::BeginOfRunAction(const G4Run* run)
   
   // Esto creará: Salida_TierrasRaras_Run0.root Y Salida_TierrasRaras_Run1.root
   analysisManager->OpenFile(fileName);
+
+  if (IsMaster()) fTimer.Start();
 }
 
-void RunAction::EndOfRunAction(const G4Run*)
+void RunAction::EndOfRunAction(const G4Run* run)
 {
   auto analysisManager = G4AnalysisManager::Instance();
   analysisManager->Write();
   analysisManager->CloseFile();
+
+  // Rendimiento: tiempo real de todo el run (todos los hilos)
+  if (IsMaster()) fTimer.Stop(run);
 }
\ No newline at end of file